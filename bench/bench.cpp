@@ -0,0 +1,637 @@
+// Benchmark suite for the simulation core. Links only against the
+// simulation library, like the headless runner.
+//
+// Every benchmark reports one or more (id, metric, value) results. They are
+// printed as a table, written as JSON with --out, and compared against a
+// previous results file with --baseline, which flags any metric that got
+// worse by more than --tolerance percent.
+//
+//   ./athens-metro-bench [--quick] [--out=FILE] [--baseline=FILE]
+//                        [--tolerance=PCT] [--sizes=10,100,...]
+//                        [--filter=SUBSTRING] [--threads=N]
+//                        [--max-route-mb=N] [--min-ms=N]
+
+#include "util/CommandLine.h"
+#include "util/Demand.h"
+#include "util/JsonReader.h"
+#include "util/NetworkImage.h"
+#include "util/NetworkGen.h"
+#include "util/NetworkLoader.h"
+#include "util/PassengerStore.h"
+#include "util/Simulation.h"
+#include <algorithm>
+#include <chrono>
+#include <cmath>
+#include <cstdio>
+#include <cstdlib>
+#include <fstream>
+#include <iomanip>
+#include <iostream>
+#include <map>
+#include <set>
+#include <sstream>
+#include <string>
+#include <vector>
+#ifdef __GLIBC__
+#include <malloc.h>
+#endif
+
+namespace {
+
+using Clock = std::chrono::steady_clock;
+
+double secondsSince(Clock::time_point start) {
+  return std::chrono::duration<double>(Clock::now() - start).count();
+}
+
+struct Result {
+  std::string id;
+  std::string metric;
+  double value;
+  std::string unit;
+  bool higherIsBetter;
+};
+
+struct Options {
+  bool quick = false;
+  std::vector<int> sizes;
+  std::string filter;
+  int threads = 1;
+  double maxRouteMb = 512.0;
+  double minSeconds = 0.3;
+};
+
+std::vector<Result> results;
+std::set<std::string> done; // ids already run by an earlier sweep
+Options options;
+
+void report(const std::string &id, const std::string &metric, double value,
+            const std::string &unit, bool higherIsBetter) {
+  results.push_back(Result{id, metric, value, unit, higherIsBetter});
+  std::cout << std::left << std::setw(56) << id << std::setw(18) << metric
+            << std::right << std::setw(14) << std::setprecision(4) << value
+            << " " << unit << std::endl;
+}
+
+/**
+ * @brief Whether a benchmark should run: it matches --filter and no other
+ * sweep has run it yet
+ */
+bool selected(const std::string &id) {
+  if (!options.filter.empty() && id.find(options.filter) == std::string::npos)
+    return false;
+  return done.insert(id).second;
+}
+
+/**
+ * @brief Resident set size of this process, 0 where /proc is unavailable
+ *
+ * Freed heap pages are handed back first, so that memory freed by an
+ * earlier measurement is not reused without showing up in the next one.
+ */
+size_t residentBytes() {
+#ifdef __GLIBC__
+  malloc_trim(0);
+#endif
+  std::ifstream status("/proc/self/status");
+  std::string line;
+  while (std::getline(status, line)) {
+    if (line.rfind("VmRSS:", 0) == 0)
+      return (size_t)std::atoll(line.c_str() + 6) * 1024;
+  }
+  return 0;
+}
+
+std::vector<std::string> skipped; // ids left out by routesFit()
+
+/**
+ * @brief Whether every station's routes fit in the route cache at once.
+ *
+ * Random traffic heads for every station, and each destination's routes
+ * take a byte per station. If they do not all fit in --max-route-mb, the
+ * cache drops and recomputes columns every tick and the benchmark would
+ * time that churn instead of the tick, so it is skipped (and listed).
+ */
+bool routesFit(const std::string &id, int stations) {
+  if ((double)stations * stations / (1024.0 * 1024.0) <= options.maxRouteMb)
+    return true;
+  skipped.push_back(id);
+  return false;
+}
+
+std::string sizeId(const char *name, int stations, int trains,
+                   int passengers) {
+  return std::string(name) + "/stations=" + std::to_string(stations) +
+         "/trains=" + std::to_string(trains) +
+         "/passengers=" + std::to_string(passengers);
+}
+
+// --- Synthetic networks ---------------------------------------------------
+
+GeneratedNetwork gridNetwork(int stations) {
+  NetworkGenOptions options;
+  options.topology = "grid";
+  options.stations = stations;
+  options.width = options.height = 40.0f * std::sqrt((float)stations);
+  return generateNetwork(options);
+}
+
+void addStations(Simulation &sim, const GeneratedNetwork &net) {
+  for (int i = 0; i < net.stationCount; ++i)
+    sim.addStation(generatedStationName(i), net.x[i], net.y[i]);
+  for (int i = 0; i < net.stationCount; ++i) {
+    for (uint32_t e = net.edgeStart[i]; e < net.edgeStart[i + 1]; ++e)
+      sim.connect(i, (int)net.edges[e]);
+  }
+}
+
+void buildGrid(Simulation &sim, int stations) {
+  sim.setRouteCacheBudget((size_t)(options.maxRouteMb * 1024 * 1024));
+  addStations(sim, gridNetwork(stations));
+  sim.buildRoutes();
+}
+
+std::string gridJson(int stations) {
+  std::ostringstream out;
+  writeNetworkJson(gridNetwork(stations), out, true);
+  return out.str();
+}
+
+void populate(Simulation &sim, int trains, int passengers) {
+  int stations = (int)sim.getStations().size();
+  Rng rng(sim.getSeed(), 99);
+  for (int i = 0; i < trains; ++i)
+    sim.addTrain((int)rng.nextBelow(stations));
+  for (int i = 0; i < passengers; ++i) {
+    int from = (int)rng.nextBelow(stations);
+    int to = (int)rng.nextBelow(stations);
+    if (from != to)
+      sim.addPassenger(from, to);
+  }
+}
+
+/**
+ * @brief Run f repeatedly until minSeconds have passed
+ * @return Median seconds per call
+ */
+template <typename F> double timeMedian(F f, int minRuns = 3) {
+  std::vector<double> samples;
+  Clock::time_point start = Clock::now();
+  while ((int)samples.size() < minRuns || secondsSince(start) < options.minSeconds) {
+    Clock::time_point t = Clock::now();
+    f();
+    samples.push_back(secondsSince(t));
+    if (samples.size() >= 1000)
+      break;
+  }
+  std::sort(samples.begin(), samples.end());
+  return samples[samples.size() / 2];
+}
+
+// --- Benchmarks -------------------------------------------------------------
+
+/**
+ * @brief Ticks per second for one network size and load
+ */
+void benchTick(int stations, int trains, int passengers) {
+  std::string id = sizeId("tick", stations, trains, passengers);
+  if (!selected(id) || !routesFit(id, stations))
+    return;
+
+  Simulation sim;
+  sim.setSeed(1);
+  sim.setThreadCount(options.threads);
+  buildGrid(sim, stations);
+  populate(sim, trains, passengers);
+
+  for (int i = 0; i < 100; ++i)
+    sim.step(Simulation::kFixedStepMs);
+
+  const int batch = 100;
+  double perBatch = timeMedian([&] {
+    for (int i = 0; i < batch; ++i)
+      sim.step(Simulation::kFixedStepMs);
+  });
+  report(id, "ticks_per_sec", batch / perBatch, "ticks/s", true);
+  report(id, "us_per_tick", perBatch / batch * 1e6, "us", false);
+}
+
+/**
+ * @brief Simulated seconds per wall second with each engine, stepping ten
+ * simulated seconds at a time
+ */
+void benchEngine(int stations, int trains, int passengers) {
+  const int simMs = 10000;
+  const struct {
+    const char *name;
+    Simulation::Engine engine;
+  } engines[] = {{"engine/tick", Simulation::TICKED},
+                 {"engine/event", Simulation::EVENT_DRIVEN}};
+
+  for (const auto &e : engines) {
+    std::string id = sizeId(e.name, stations, trains, passengers);
+    if (!selected(id) || !routesFit(id, stations))
+      continue;
+
+    Simulation sim;
+    sim.setSeed(1);
+    sim.setThreadCount(options.threads);
+    sim.setEngine(e.engine);
+    buildGrid(sim, stations);
+    populate(sim, trains, passengers);
+
+    double perRun = timeMedian([&] {
+      if (e.engine == Simulation::EVENT_DRIVEN) {
+        sim.step(simMs);
+      } else {
+        for (int ms = 0; ms < simMs; ms += Simulation::kFixedStepMs)
+          sim.step(Simulation::kFixedStepMs);
+      }
+    });
+    report(id, "sim_x_real_time", simMs / 1000.0 / perRun, "x", true);
+  }
+}
+
+/**
+ * @brief Cost of one train arriving at a station: alighting, dispatch,
+ * transfers and boarding
+ *
+ * Steps are long enough for every train to cover the longest edge, so
+ * each train arrives once per step and the step time is almost all arrival
+ * handling.
+ */
+void benchArrival(int stations, int trains, int passengers) {
+  std::string id = sizeId("arrival", stations, trains, passengers);
+  if (!selected(id) || !routesFit(id, stations))
+    return;
+
+  Simulation sim;
+  sim.setSeed(1);
+  sim.setThreadCount(options.threads);
+  buildGrid(sim, stations);
+  populate(sim, trains, passengers);
+
+  float longest = 0.0f;
+  for (const SimStation &station : sim.getStations()) {
+    for (const SimEdge &edge : station.edges)
+      longest = std::max(longest, edge.length);
+  }
+  const int stepMs = (int)std::ceil(longest * 1000.0f / sim.getLineSpeed());
+  long long arrivalsBefore = sim.getArrivalCount();
+  Clock::time_point start = Clock::now();
+  timeMedian([&] { sim.step(stepMs); });
+  double total = secondsSince(start);
+  long long arrivals = sim.getArrivalCount() - arrivalsBefore;
+  if (arrivals > 0)
+    report(id, "ns_per_arrival", total / (double)arrivals * 1e9, "ns",
+           false);
+}
+
+/**
+ * @brief Compile, map and load a network of the given size
+ */
+void benchLoad(int stations) {
+  std::string id = "load/stations=" + std::to_string(stations);
+  if (!selected(id))
+    return;
+
+  std::string json = gridJson(stations);
+  uint64_t hash = NetworkImage::hashBytes(json.data(), json.size());
+
+  NetworkImage image;
+  double compile = timeMedian([&] {
+    std::istringstream in(json);
+    image = NetworkImage::compile(in, hash);
+  });
+  report(id, "compile_ms", compile * 1e3, "ms", false);
+  report(id, "compile_mb_per_sec", json.size() / compile / (1024.0 * 1024.0),
+         "MB/s", true);
+
+  std::string path = "bench-image.tmp";
+  if (image.save(path)) {
+    double map = timeMedian([&] { image = NetworkImage::map(path); });
+    report(id, "map_ms", map * 1e3, "ms", false);
+    std::remove(path.c_str());
+  }
+
+  double load = timeMedian(
+      [&] {
+        Simulation sim;
+        loadNetwork(sim, image, 800, 600);
+      },
+      1);
+  report(id, "load_ms", load * 1e3, "ms", false);
+
+  Simulation sim;
+  loadNetwork(sim, image, 800, 600);
+  double routes = timeMedian([&] { sim.buildRoutes(); }, 1);
+  report(id, "build_routes_ms", routes * 1e3, "ms", false);
+
+  // Before any route is cached: the index alone
+  const RoutingTable &table = sim.getRoutes();
+  report(id, "routes_mb", table.memoryBytes() / (1024.0 * 1024.0), "MB",
+         false);
+
+  // The first rider heading for a station computes its routes; each call
+  // asks for a station not routed to yet
+  int destination = 0;
+  double column = timeMedian(
+      [&] {
+        table.nextHopSlot(0, destination);
+        if (++destination == stations) {
+          sim.buildRoutes(); // all cached: start over
+          destination = 0;
+        }
+      },
+      1);
+  report(id, "route_column_ms", column * 1e3, "ms", false);
+}
+
+/**
+ * @brief Passengers the demand generator can spawn per second
+ */
+void benchDemand(int stations) {
+  std::string id = "demand/stations=" + std::to_string(stations);
+  if (!selected(id) || !routesFit(id, stations))
+    return;
+
+  Simulation sim;
+  buildGrid(sim, stations);
+  DemandModel model(stations);
+  model.setBackgroundRate(1e6 / stations); // a million riders an hour
+  model.setProfile(DemandProfile::commuter());
+
+  const long long hourMs = 60LL * 60 * 1000;
+  long long now = 0;
+  long long before = 0;
+  DemandGenerator generator(model, sim.makeRng(Rng::DEMAND));
+  double perHour = timeMedian(
+      [&] {
+        before = generator.getSpawned();
+        now += hourMs;
+        generator.generate(sim, now);
+      },
+      1);
+  double spawned = (double)(generator.getSpawned() - before);
+  report(id, "arrivals_per_sec", spawned / perHour, "riders/s", true);
+}
+
+/**
+ * @brief Resident memory per station, train and passenger
+ */
+void benchMemory() {
+  if (!selected("memory"))
+    return;
+
+  {
+    const int count = options.quick ? 100000 : 1000000;
+    Simulation sim;
+    buildGrid(sim, 100);
+    size_t before = residentBytes();
+    for (int i = 0; i < count; ++i)
+      sim.addPassenger(i % 100, (i + 1) % 100);
+    size_t after = residentBytes();
+    if (after > before)
+      report("memory/passenger", "bytes", (double)(after - before) / count,
+             "B", false);
+    report("memory/passenger", "column_bytes",
+           (double)PassengerStore::kBytesPerPassenger, "B", false);
+  }
+  {
+    const int count = options.quick ? 10000 : 100000;
+    GeneratedNetwork net = gridNetwork(count);
+    Simulation sim;
+    size_t before = residentBytes();
+    addStations(sim, net);
+    size_t after = residentBytes();
+    if (after > before)
+      report("memory/station", "bytes", (double)(after - before) / count,
+             "B", false);
+  }
+  {
+    const int count = options.quick ? 10000 : 100000;
+    Simulation sim;
+    buildGrid(sim, 100);
+    size_t before = residentBytes();
+    for (int i = 0; i < count; ++i)
+      sim.addTrain(i % 100);
+    size_t after = residentBytes();
+    if (after > before)
+      report("memory/train", "bytes", (double)(after - before) / count, "B",
+             false);
+  }
+}
+
+// --- Results files ----------------------------------------------------------
+
+std::string jsonEscape(const std::string &s) {
+  std::string out;
+  for (char c : s) {
+    if (c == '"' || c == '\\')
+      out.push_back('\\');
+    out.push_back(c);
+  }
+  return out;
+}
+
+bool writeResults(const std::string &path) {
+  std::ofstream out(path);
+  if (!out)
+    return false;
+  out << "{\n  \"schema\": 1,\n  \"quick\": " << (options.quick ? "true" : "false")
+      << ",\n  \"threads\": " << options.threads << ",\n  \"results\": [";
+  for (size_t i = 0; i < results.size(); ++i) {
+    const Result &r = results[i];
+    out << (i ? "," : "") << "\n    {\"id\": \"" << jsonEscape(r.id)
+        << "\", \"metric\": \"" << r.metric << "\", \"value\": "
+        << std::setprecision(9) << r.value << ", \"unit\": \"" << r.unit
+        << "\", \"higher_is_better\": " << (r.higherIsBetter ? "true" : "false")
+        << "}";
+  }
+  out << "\n  ]\n}\n";
+  return (bool)out;
+}
+
+/**
+ * @brief Read the values of a results file, keyed by "id metric"
+ * @throws std::runtime_error if the file cannot be read or parsed
+ */
+std::map<std::string, double> readResults(const std::string &path) {
+  std::ifstream file(path);
+  if (!file)
+    throw std::runtime_error("Could not open " + path);
+
+  std::map<std::string, double> values;
+  JsonReader reader(file);
+  if (reader.next() != JsonReader::BEGIN_OBJECT)
+    reader.fail("expected an object");
+  while (reader.next() == JsonReader::KEY) {
+    if (reader.text() != "results") {
+      reader.skipValue();
+      continue;
+    }
+    if (reader.next() != JsonReader::BEGIN_ARRAY)
+      reader.fail("expected \"results\" to be an array");
+    while (reader.next() == JsonReader::BEGIN_OBJECT) {
+      std::string id, metric;
+      double value = 0.0;
+      while (reader.next() == JsonReader::KEY) {
+        std::string key = reader.text();
+        JsonReader::Token token = reader.next();
+        if (token == JsonReader::BEGIN_OBJECT ||
+            token == JsonReader::BEGIN_ARRAY)
+          reader.skipContainer();
+        else if (key == "id")
+          id = reader.text();
+        else if (key == "metric")
+          metric = reader.text();
+        else if (key == "value" && token == JsonReader::NUMBER)
+          value = reader.number();
+      }
+      values[id + " " + metric] = value;
+    }
+  }
+  return values;
+}
+
+/**
+ * @brief Print every metric next to its baseline value
+ * @return Number of metrics that got worse by more than tolerance percent
+ */
+int compareResults(const std::map<std::string, double> &baseline,
+                   double tolerance) {
+  int regressions = 0;
+  std::cout << std::endl << "Compared with baseline (tolerance " << tolerance
+            << "%):" << std::endl;
+  for (const Result &r : results) {
+    auto it = baseline.find(r.id + " " + r.metric);
+    if (it == baseline.end() || it->second == 0.0)
+      continue;
+    double change = (r.value - it->second) / it->second * 100.0;
+    double worse = r.higherIsBetter ? -change : change;
+    bool regressed = worse > tolerance;
+    regressions += regressed;
+    std::cout << (regressed ? "  REGRESSION " : "             ") << std::left
+              << std::setw(56) << r.id << std::setw(18) << r.metric
+              << std::right << std::showpos << std::fixed
+              << std::setprecision(1) << std::setw(8) << change << "%"
+              << std::noshowpos << std::defaultfloat << std::endl;
+  }
+  return regressions;
+}
+
+std::vector<int> parseSizes(const std::string &list) {
+  std::vector<int> sizes;
+  std::istringstream in(list);
+  std::string item;
+  while (std::getline(in, item, ',')) {
+    int n = std::atoi(item.c_str());
+    if (n > 1)
+      sizes.push_back(n);
+  }
+  return sizes;
+}
+
+} // namespace
+
+int main(int argc, char *argv[]) {
+#ifdef __GLIBC__
+  // A fixed threshold, so large blocks always come from (and go back to)
+  // mmap and resident memory follows them
+  mallopt(M_MMAP_THRESHOLD, 128 * 1024);
+#endif
+  options.quick = hasArg(argc, argv, "--quick");
+  options.sizes = parseSizes(getArgValue(
+      argc, argv, "--sizes", options.quick ? "10,100,1000" : "10,100,1000,10000,100000"));
+  options.filter = getArgValue(argc, argv, "--filter");
+  options.threads = std::atoi(getArgValue(argc, argv, "--threads", "1").c_str());
+  options.maxRouteMb =
+      std::atof(getArgValue(argc, argv, "--max-route-mb", "512").c_str());
+  options.minSeconds =
+      std::atof(getArgValue(argc, argv, "--min-ms", options.quick ? "100" : "300")
+                    .c_str()) /
+      1000.0;
+  std::string outPath = getArgValue(argc, argv, "--out");
+  std::string baselinePath = getArgValue(argc, argv, "--baseline");
+  double tolerance =
+      std::atof(getArgValue(argc, argv, "--tolerance", "10").c_str());
+
+  std::cout << "Simulation benchmarks (" << options.threads << " thread(s)"
+            << (options.quick ? ", quick" : "") << ")" << std::endl;
+  std::cout << "Traffic benchmarks on networks whose routes to every"
+            << " station need more than " << options.maxRouteMb
+            << " MB are skipped and listed at the end"
+            << std::endl
+            << std::endl;
+
+  // First, while the heap is fresh, so resident memory grows with what is
+  // allocated rather than being served from pages freed by earlier runs
+  benchMemory();
+
+  // Network size
+  for (int n : options.sizes)
+    benchLoad(n);
+  for (int n : options.sizes)
+    benchTick(n, std::max(1, n / 10), n * 10);
+  for (int n : options.sizes)
+    benchArrival(n, std::max(1, n / 10), n * 10);
+  for (int n : options.sizes)
+    benchDemand(n);
+  for (int n : options.sizes)
+    benchEngine(n, std::max(1, n / 100), n);
+
+  // Train and passenger count on a fixed network
+  const int base = 1000;
+  for (int trains : {10, 100, 1000, 10000}) {
+    if (!options.quick || trains <= 1000) {
+      benchTick(base, trains, 10000);
+      benchArrival(base, trains, 10000);
+      benchEngine(base, trains, 1000);
+    }
+  }
+  for (int passengers : {1000, 10000, 100000, 1000000}) {
+    if (!options.quick || passengers <= 100000) {
+      benchTick(base, 100, passengers);
+      benchArrival(base, 100, passengers);
+    }
+  }
+
+  if (!skipped.empty()) {
+    std::cout << std::endl
+              << "Skipped " << skipped.size()
+              << " benchmark(s): routes to every station would not fit in "
+              << options.maxRouteMb
+              << " MB, so the route cache would be rebuilt every tick"
+              << std::endl;
+    for (const std::string &id : skipped)
+      std::cout << "  " << id << std::endl;
+  }
+
+  if (!outPath.empty()) {
+    if (!writeResults(outPath)) {
+      std::cerr << "Could not write " << outPath << std::endl;
+      return 1;
+    }
+    std::cout << std::endl << "Results written to " << outPath << std::endl;
+  }
+
+  if (!baselinePath.empty()) {
+    std::ifstream probe(baselinePath);
+    if (!probe) {
+      std::cout << "No baseline at " << baselinePath
+                << " yet; nothing to compare" << std::endl;
+      return 0;
+    }
+    try {
+      int regressions = compareResults(readResults(baselinePath), tolerance);
+      if (regressions > 0) {
+        std::cout << regressions << " metric(s) regressed" << std::endl;
+        return 1;
+      }
+    } catch (const std::runtime_error &e) {
+      std::cerr << "Baseline error: " << e.what() << std::endl;
+      return 1;
+    }
+  }
+  return 0;
+}
@@ -1,73 +1,124 @@
+#include "util/CommandLine.h"
+#include "util/Dispatch.h"
 #include "util/GlobalState.h"
-#include "util/Passenger.h"
+#include "util/Headless.h"
+#include "util/Journal.h"
+#include "util/NetworkLoader.h"
+#include "util/PassengerLayer.h"
+#include "util/Profiler.h"
+#include "util/Scenario.h"
 #include "util/SimulateButton.h"
 #include "util/Station.h"
 #include "util/Train.h"
 #include <chrono>
 #include <cmath>
-#include <ctime>
 #include <fstream>
 #include <iostream>
-#include <map>
-#include <queue>
-#include <random>
+#include <memory>
 #include <sgg/graphics.h>
+#include <stdexcept>
 #include <string>
 #include <vector>
 
 Station *Station::s_active_dragging_station =
     nullptr; // active dragging station
 
-int totalPassengers = 0;
-int completedPassengers = 0;
-
 // Forward declarations for callback functions
 void draw();
 void update(float ms);
 
+// The window's game state. SGG callbacks take no arguments, so they reach
+// it through this pointer, set by main() for the life of the message loop.
+static GlobalState *game = nullptr;
+
+/**
+ * @brief HUD lines, rebuilt only when the value they show changes
+ *
+ * The HUD is drawn every frame but its numbers change far less often, so
+ * the strings are kept between frames instead of being formatted anew.
+ */
+struct HudText {
+  int score = -1;
+  int level = -1;
+  int warp = -1;
+  int completed = -1;
+  int total = -1;
+  std::string scoreText;
+  std::string levelText;
+  std::string speedText;
+  std::string progressText;
+
+  void refresh(const GlobalState &gs) {
+    if (gs.getScore() != score) {
+      score = gs.getScore();
+      scoreText = "Score: " + std::to_string(score);
+    }
+    if (gs.getLevel() != level) {
+      level = gs.getLevel();
+      levelText = "Level: " + std::to_string(level);
+    }
+    if ((int)gs.getTimeWarp() != warp) {
+      warp = (int)gs.getTimeWarp();
+      speedText = "Speed: " + std::to_string(warp) + "x  (+/-)";
+    }
+    if (gs.getCompletedPassengers() != completed ||
+        gs.getTotalPassengers() != total) {
+      completed = gs.getCompletedPassengers();
+      total = gs.getTotalPassengers();
+      progressText =
+          "Arrived: " + std::to_string(completed) + "/" + std::to_string(total);
+    }
+  }
+};
+
+static HudText hud;
+
+static graphics::Brush makeBrush(float r, float g, float b) {
+  graphics::Brush brush;
+  brush.fill_color[0] = r;
+  brush.fill_color[1] = g;
+  brush.fill_color[2] = b;
+  return brush;
+}
+
 /**
  * @brief Main draw callback function
  *
  * This function is called by SGG every frame to render the scene.
  * It delegates to GlobalState which calls draw() on all VisualAssets.
+ * While nothing changes GlobalState slows the frame rate down, so idle
+ * frames are drawn only a few times a second.
  */
 void draw() {
+  static const graphics::Brush bg = makeBrush(0.1f, 0.1f, 0.15f);
+  static const graphics::Brush titleBrush = makeBrush(1.0f, 1.0f, 1.0f);
+  static const graphics::Brush scoreBrush = makeBrush(0.8f, 0.9f, 1.0f);
+  static const graphics::Brush instructionBrush = makeBrush(0.7f, 0.7f, 0.7f);
+
+  GlobalState &gs = *game;
+  hud.refresh(gs);
+
   // Clear background
-  graphics::Brush bg;
-  bg.fill_color[0] = 0.1f;
-  bg.fill_color[1] = 0.1f;
-  bg.fill_color[2] = 0.15f;
   graphics::drawRect(400, 300, 800, 600, bg);
 
   // Draw title
-  graphics::Brush titleBrush;
-  titleBrush.fill_color[0] = 1.0f;
-  titleBrush.fill_color[1] = 1.0f;
-  titleBrush.fill_color[2] = 1.0f;
   graphics::drawText(250, 50, 28, "Athens Metro Manager - Demo", titleBrush);
 
-  // Draw score
-  graphics::Brush scoreBrush;
-  scoreBrush.fill_color[0] = 0.8f;
-  scoreBrush.fill_color[1] = 0.9f;
-  scoreBrush.fill_color[2] = 1.0f;
-  std::string scoreText =
-      "Score: " + std::to_string(GlobalState::getInstance().getScore());
-  graphics::drawText(50, 100, 18, scoreText, scoreBrush);
-
-  // Draw level
-  std::string levelText =
-      "Level: " + std::to_string(GlobalState::getInstance().getLevel());
-  graphics::drawText(50, 130, 18, levelText, scoreBrush);
+  // Draw score, level, time-warp factor and journey progress
+  graphics::drawText(50, 100, 18, hud.scoreText, scoreBrush);
+  graphics::drawText(50, 130, 18, hud.levelText, scoreBrush);
+  graphics::drawText(50, 160, 18, hud.speedText, scoreBrush);
+  graphics::drawText(50, 190, 18, hud.progressText, scoreBrush);
 
   // Draw all visual assets (stations) through GlobalState
-  GlobalState::getInstance().draw();
+  gs.draw();
+
+  if (gs.isRunComplete()) {
+    graphics::drawText(250, 90, 20, "All passengers have arrived!",
+                       titleBrush);
+  }
 
   // Draw instructions
-  graphics::Brush instructionBrush;
-  instructionBrush.fill_color[0] = 0.7f;
-  instructionBrush.fill_color[1] = 0.7f;
-  instructionBrush.fill_color[2] = 0.7f;
   graphics::drawText(
       200, 550, 14,
       "Demonstrating VisualAsset polymorphism with Station objects",
@@ -82,77 +133,66 @@ void draw() {
  * It delegates to GlobalState which calls update() on all VisualAssets.
  */
 void update(float ms) {
-  GlobalState &gs = GlobalState::getInstance();
   // Update all visual assets through GlobalState
-  gs.update(static_cast<int>(ms));
-
-  // Check if all passengers have completed their journey
-  if (gs.isSimulating()) {
-    totalPassengers = 0;
-    completedPassengers = 0;
-    const auto &passengers = gs.getPassengers();
-
-    for (VisualAsset *asset : passengers) {
-      // With categorized vectors, we can safely static_cast if we are sure of
-      // the type
-      Passenger *p = static_cast<Passenger *>(asset);
-      if (p) {
-        totalPassengers++;
-        if (p->getState() == Passenger::COMPLETED) {
-          completedPassengers++;
-        }
-      }
-    }
-
-    // End simulation if all passengers have arrived
-    if (totalPassengers > 0 && totalPassengers == completedPassengers) {
-      std::this_thread::sleep_for(std::chrono::seconds(1));
-      std::cout << "All passengers have arrived! Simulation Ending."
-                << std::endl;
-      std::cout << "Final score: " << gs.getScore() << std::endl;
-      // Using exit(0) ensures the application terminates immediately 
-      // without waiting for additional input events to process a shutdown signal.
-      std::exit(0);
-    }
-  }
+  game->update(ms);
 }
 
-// Forward declaration
-void runSimulation();
+/**
+ * @brief End-of-run hook, called once when all passengers have arrived
+ */
+void onRunComplete(const RunResult &result) {
+  std::cout << "All passengers have arrived! Simulation Ending." << std::endl;
+  std::cout << "Final score: " << result.score << " after "
+            << result.simMs / 1000.0 << " simulated seconds" << std::endl;
+}
 
-void runSimulation() {
+void runSimulation(GlobalState &gs) {
   std::cout << "Simulation started!" << std::endl;
-  GlobalState::getInstance().setSimulating(true);
+  gs.setSimulating(true);
 }
 
 // Helper to add button
-void setupSimulationButton() {
-  GlobalState &gs = GlobalState::getInstance();
+void setupSimulationButton(GlobalState &gs) {
   // Place button at bottom right
   float btnW = 120.0f;
   float btnH = 40.0f;
   float btnX = gs.getWindowWidth() - btnW / 2 - 20;
   float btnY = gs.getWindowHeight() - btnH / 2 - 20;
 
-  SimulateButton *btn =
-      new SimulateButton(btnX, btnY, btnW, btnH, "Simulate", runSimulation);
-  gs.addVisualAsset(btn);
+  gs.create<SimulateButton>(btnX, btnY, btnW, btnH, "Simulate",
+                            [&gs] { runSimulation(gs); });
 }
 
 /**
  * @brief Main entry point
  *
  * Sets up the SGG window, creates demo stations, and starts the message loop.
+ * With --headless no window is created and the simulation runs unattended.
  */
 int main(int argc, char *argv[]) {
-  // Check for -DEBUG flag
-  bool debug = false;
-  for (int i = 1; i < argc; ++i) {
-    if (std::string(argv[i]) == "-DEBUG") {
-      debug = true;
-      break;
-    }
+  // Check for -DEBUG / --headless / --trace flags
+  if (hasArg(argc, argv, "--headless")) {
+    return runHeadless(argc, argv);
   }
+  bool debug = hasArg(argc, argv, "-DEBUG");
+
+  // Check the options before opening a window, as the headless runner does
+  std::string policy = getArgValue(argc, argv, "--dispatch", "demand");
+  std::unique_ptr<DispatchPolicy> dispatch = makeDispatchPolicy(policy);
+  if (!dispatch) {
+    std::cerr << "Unknown dispatch policy '" << policy << "'" << std::endl;
+    return 1;
+  }
+  std::string engine = getArgValue(argc, argv, "--engine", "tick");
+  if (engine != "tick" && engine != "event") {
+    std::cerr << "Unknown engine '" << engine << "'" << std::endl;
+    return 1;
+  }
+
+  // --trace=<path> records every update/draw phase for chrome://tracing
+  std::string tracePath = getArgValue(argc, argv, "--trace");
+  Profiler::setThreadName("main");
+  Profiler::setEnabled(!tracePath.empty());
 
   // Create window with SGG
   graphics::createWindow(800, 600, "Athens Metro Manager");
@@ -163,8 +203,9 @@ int main(int argc, char *argv[]) {
   // Set canvas scale mode (fit was adviced)
   graphics::setCanvasScaleMode(graphics::CANVAS_SCALE_FIT);
 
-  // Get GlobalState instance
-  GlobalState &gs = GlobalState::getInstance();
+  // The game state, owned here and shared with the SGG callbacks
+  GlobalState gs;
+  game = &gs;
 
   // Set debug mode
   gs.setDebugMode(debug);
@@ -175,160 +216,58 @@ int main(int argc, char *argv[]) {
   // Initialize GlobalState
   gs.init();
 
-  setupSimulationButton();
-
-  // Get GlobalState instance
-
-  std::srand(std::time(nullptr)); // Seed std::rand
-  std::mt19937 rng(std::chrono::steady_clock::now().time_since_epoch().count());
-  std::uniform_int_distribution<int> x_dist(50, gs.getWindowWidth() -
-                                                    50); // Avoid edges
-  std::uniform_int_distribution<int> y_dist(
-      150, gs.getWindowHeight() - 50); // Avoid top for title/score
-
-  std::map<std::string, Station *> stations_map;
+  setupSimulationButton(gs);
+
+  // Seed the run and pick the initial time-warp
+  Simulation &sim = gs.getSimulation();
+  sim.setSeed(getSeedArg(argc, argv));
+  std::cout << "Seed: " << sim.getSeed() << std::endl;
+  gs.setTimeWarp(std::atof(getArgValue(argc, argv, "--warp", "1").c_str()));
+  sim.setDispatchPolicy(std::move(dispatch));
+  sim.setThreadCount(
+      std::atoi(getArgValue(argc, argv, "--threads", "1").c_str()));
+  if (engine == "event")
+    sim.setEngine(Simulation::EVENT_DRIVEN);
+  sim.setLineSpeed((float)std::atof(
+      getArgValue(argc, argv, "--line-speed",
+                  std::to_string(Simulation::kDefaultLineSpeed))
+          .c_str()));
 
   try {
-    std::ifstream f("assets/metro3.json");
-    if (!f.is_open()) {
-      throw std::runtime_error("Could not open assets/metro3.json");
-    }
-    Json::Value data;
-    f >> data;
-
-    // First pass: Create all stations and add them to the map and GlobalState
-    if (data.isMember("stations") && data["stations"].isArray()) {
-      for (const auto &station_json : data["stations"]) {
-        if (station_json.isMember("name") && station_json["name"].isString()) {
-          std::string name = station_json["name"].asString();
-          int random_x, random_y;
-          bool position_found = false;
-          const int MIN_SPACING_SQUARED = 100 * 100; // Minimum distance squared
-
-          // Try to find a non-overlapping position
-          int attempts = 0;
-          const int MAX_ATTEMPTS =
-              1000; // Prevent infinite loops in dense scenarios
-          while (!position_found && attempts < MAX_ATTEMPTS) {
-            random_x = x_dist(rng);
-            random_y = y_dist(rng);
-            position_found =
-                true; // Assume position is good until collision is found
-
-            for (const auto &pair : stations_map) {
-              Station *existing_station = pair.second;
-              float dx = random_x - existing_station->getX();
-              float dy = random_y - existing_station->getY();
-              if ((dx * dx + dy * dy) < MIN_SPACING_SQUARED) {
-                position_found = false; // Collision detected, try again
-                break;
-              }
-            }
-            attempts++;
-          }
-
-          if (!position_found) {
-            if (gs.isDebugMode()) {
-              std::cerr << "Warning: Could not find a non-overlapping position "
-                           "for station '"
-                        << name << "' after " << MAX_ATTEMPTS
-                        << " attempts. Placing it anyway." << std::endl;
-            }
-            // Fallback: place it even if it overlaps, or handle error
-            random_x = x_dist(rng); // Place randomly one last time
-            random_y = y_dist(rng);
-          }
-
-          Station *station = new Station(random_x, random_y, name);
-          stations_map[name] = station;
-          gs.addStation(station);
-        }
-      }
-    }
-
-    // Second pass: Establish connections
-    if (data.isMember("stations") && data["stations"].isArray()) {
-      for (const auto &station_json : data["stations"]) {
-        if (station_json.isMember("name") && station_json["name"].isString()) {
-          std::string name = station_json["name"].asString();
-          Station *current_station = stations_map[name];
-
-          if (station_json.isMember("connections") &&
-              station_json["connections"].isArray()) {
-            for (const auto &connection_name_json :
-                 station_json["connections"]) {
-              if (connection_name_json.isString()) {
-                std::string connection_name = connection_name_json.asString();
-                if (stations_map.count(connection_name)) {
-                  current_station->addNext(stations_map[connection_name]);
-                } else {
-                  if (gs.isDebugMode()) {
-                    std::cerr << "Warning: Connection to unknown station '"
-                              << connection_name << "' for station '" << name
-                              << "'" << std::endl;
-                  }
-                }
-              }
-            }
-          }
-        }
-      }
-    }
+    loadNetwork(sim, "assets/metro3.json", gs.getWindowWidth(),
+                gs.getWindowHeight());
   } catch (const std::runtime_error &e) {
     std::cerr << "File error: " << e.what() << std::endl;
   }
 
-  // Randomly spawn trains and passengers for demo
-  std::vector<Station *> station_list;
-  for (auto const &[name, station] : stations_map) {
-    station_list.push_back(station);
+  // --journal=<path> records every rider event to a binary journal
+  std::string journalPath = getArgValue(argc, argv, "--journal");
+  if (!journalPath.empty()) {
+    std::unique_ptr<Journal> journal(new Journal());
+    try {
+      journal->open(journalPath);
+      sim.setJournal(std::move(journal));
+    } catch (const std::runtime_error &e) {
+      std::cerr << "Journal error: " << e.what() << std::endl;
+    }
   }
 
-  if (!station_list.empty() && station_list.size() >= 3) {
-    int used_stations[3];
-
-    for (int i = 0; i < 3; ++i) {
-      int startIdx;
-      bool is_duplicate;
-
-      do {
-        is_duplicate = false;
-        startIdx = rand() % station_list.size();
-
-        // Check against all previously selected indices
-        for (int j = 0; j < i; ++j) {
-          if (used_stations[j] == startIdx) {
-            is_duplicate = true;
-            break;
-          }
-        }
-      } while (is_duplicate);
-
-      used_stations[i] = startIdx;
-      Station *start = station_list[startIdx];
-      Train *train = new Train(start->getX(), start->getY(), start);
-      gs.addTrain(train);
-    }
+  // Randomly spawn trains and passengers for demo, then keep riders coming
+  setupDemoScenario(sim);
+  try {
+    setupDemand(sim, getDemandArgs(argc, argv, 60.0));
+  } catch (const std::runtime_error &e) {
+    std::cerr << "Demand error: " << e.what() << std::endl;
   }
-  // Spawn 20 passengers with random destinations
-  for (int i = 0; i < 20; ++i) {
-    int startIdx = rand() % station_list.size();
-    int endIdx = rand() % station_list.size();
-
-    // Ensure dest != start ideally, and make sure not more than 6 passengers
-    // spawn in the same station
-    while (startIdx == endIdx && station_list.size() > 1) {
-      endIdx = rand() % station_list.size();
-    }
 
-    if (station_list[startIdx]->getPassengerCount() <= 6) {
-      Station *start = station_list[startIdx];
-      Station *end = station_list[endIdx];
-      Passenger *p = new Passenger(start->getX(), start->getY(), end);
-      gs.addPassenger(p);
-      start->addWaitingPassenger(p);
-    }
+  // Create the views over the simulation
+  for (int i = 0; i < (int)sim.getStations().size(); ++i) {
+    gs.create<Station>(sim, i);
+  }
+  for (int i = 0; i < (int)sim.getTrains().size(); ++i) {
+    gs.create<Train>(sim, i);
   }
+  gs.create<PassengerLayer>(sim);
 
   std::cout << "Athens Metro Manager Demo Started!" << std::endl;
   if (gs.isDebugMode()) {
@@ -336,13 +275,14 @@ int main(int argc, char *argv[]) {
     std::cout
         << "  - VisualAsset base class with polymorphic draw() and update()"
         << std::endl;
-    std::cout << "  - GlobalState singleton managing all visual assets"
+    std::cout << "  - GlobalState managing all visual assets"
               << std::endl;
     std::cout << "  - Station class inheriting from VisualAsset" << std::endl;
     std::cout << "  - SGG library integration" << std::endl;
   }
 
   // Set callback functions for SGG
+  gs.setOnRunComplete(onRunComplete);
   graphics::setDrawFunction(draw);
   graphics::setUpdateFunction(update);
 
@@ -354,5 +294,21 @@ int main(int argc, char *argv[]) {
 
   std::cout << "Demo ended. Final score: " << gs.getScore() << std::endl;
 
+  if (Journal *journal = sim.getJournal()) {
+    if (journal->close())
+      std::cout << "Journaled " << journal->getRecorded() << " events to "
+                << journalPath << std::endl;
+    else
+      std::cerr << "Could not write journal to " << journalPath << std::endl;
+  }
+
+  if (!tracePath.empty()) {
+    Profiler::setEnabled(false);
+    if (Profiler::writeChromeTrace(tracePath))
+      std::cout << "Trace written to " << tracePath << std::endl;
+    else
+      std::cerr << "Could not write trace to " << tracePath << std::endl;
+  }
+
   return 0;
 }
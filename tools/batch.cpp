@@ -0,0 +1,147 @@
+// Monte Carlo batch runner: runs every combination of the given networks and
+// fleet sizes over many seeds, all cores at once, and reports the spread of
+// score, completion time and rider wait time for each.
+//
+//   ./athens-metro-batch [--runs=N] [--seed=FIRST] [--threads=N]
+//                        [--network=A.json,B.json,...] [--trains=3,6,...]
+//                        [--riders=N] [--dispatch=POLICY]
+//                        [--engine=event|tick] [--line-speed=V]
+//                        [--max-minutes=N] [--demand=R ...] [--csv=FILE]
+//
+// Run i of a scenario uses seed FIRST + i, so any run can be replayed with
+// athens-metro-headless --seed=SEED --trains=N --riders=N. --csv writes one
+// line per run.
+#include "util/BatchRunner.h"
+#include "util/CommandLine.h"
+#include "util/Dispatch.h"
+#include <cstdio>
+#include <cstdlib>
+#include <fstream>
+#include <iomanip>
+#include <iostream>
+#include <sstream>
+#include <stdexcept>
+#include <string>
+#include <vector>
+
+static std::vector<std::string> splitList(const std::string &list) {
+  std::vector<std::string> items;
+  std::stringstream in(list);
+  std::string item;
+  while (std::getline(in, item, ',')) {
+    if (!item.empty())
+      items.push_back(item);
+  }
+  return items;
+}
+
+static void printStats(const char *label, const SampleStats &stats,
+                       double scale, const char *unit) {
+  std::cout << "  " << std::left << std::setw(12) << label << std::right
+            << std::fixed << std::setprecision(2) << "mean "
+            << stats.mean / scale << unit << "  p50 " << stats.p50 / scale
+            << unit << "  p90 " << stats.p90 / scale << unit << "  min "
+            << stats.min / scale << unit << "  max " << stats.max / scale
+            << unit << std::defaultfloat << std::setprecision(6)
+            << std::endl;
+}
+
+static void printSummary(const BatchSummary &summary, int threads) {
+  const BatchScenario &scenario = summary.scenario;
+  std::cout << scenario.name << ": " << summary.results.size() << " runs ("
+            << summary.finishedRuns << " finished) in " << std::fixed
+            << std::setprecision(2) << summary.wallSeconds << " s on "
+            << threads << " thread(s)" << std::defaultfloat
+            << std::setprecision(6) << std::endl;
+  printStats("score", summary.score, 1.0, "");
+  printStats("completion", summary.completionMs, 1000.0, " s");
+
+  const Histogram &waits = summary.waitTimes;
+  std::cout << "  " << std::left << std::setw(12) << "wait" << std::right
+            << std::fixed << std::setprecision(2) << "mean "
+            << waits.getMean() / 1000.0 << " s  p50 "
+            << waits.percentile(50) / 1000.0 << " s  p90 "
+            << waits.percentile(90) / 1000.0 << " s  p99 "
+            << waits.percentile(99) / 1000.0 << " s  max "
+            << waits.getMax() / 1000.0 << " s  (" << waits.getCount()
+            << " boardings)" << std::defaultfloat << std::setprecision(6)
+            << std::endl;
+}
+
+int main(int argc, char *argv[]) {
+  int runs = std::atoi(getArgValue(argc, argv, "--runs", "100").c_str());
+  uint64_t firstSeed =
+      std::strtoull(getArgValue(argc, argv, "--seed", "1").c_str(), nullptr, 10);
+  int threads = std::atoi(getArgValue(argc, argv, "--threads", "0").c_str());
+  std::vector<std::string> networks =
+      splitList(getArgValue(argc, argv, "--network", "assets/metro3.json"));
+  std::vector<std::string> fleets =
+      splitList(getArgValue(argc, argv, "--trains", "3"));
+  std::string csvPath = getArgValue(argc, argv, "--csv");
+
+  std::string engine = getArgValue(argc, argv, "--engine", "event");
+  if (engine != "tick" && engine != "event") {
+    std::cerr << "batch: unknown engine '" << engine << "'" << std::endl;
+    return 1;
+  }
+
+  BatchScenario base;
+  base.riders = std::atoi(getArgValue(argc, argv, "--riders", "20").c_str());
+  base.dispatch = getArgValue(argc, argv, "--dispatch", "demand");
+  base.engine =
+      engine == "tick" ? Simulation::TICKED : Simulation::EVENT_DRIVEN;
+  base.lineSpeed = (float)std::atof(
+      getArgValue(argc, argv, "--line-speed",
+                  std::to_string(Simulation::kDefaultLineSpeed))
+          .c_str());
+  base.maxSimMs =
+      std::atoll(getArgValue(argc, argv, "--max-minutes", "1440").c_str()) *
+      60 * 1000;
+  base.demand = getDemandArgs(argc, argv, 0.0);
+
+  std::ofstream csv;
+  if (!csvPath.empty()) {
+    csv.open(csvPath);
+    if (!csv) {
+      std::cerr << "batch: could not open " << csvPath << std::endl;
+      return 1;
+    }
+    csv << "network,trains,seed,score,passengers,completed,all_arrived,"
+           "sim_ms\n";
+  }
+
+  BatchRunner runner(threads);
+  for (const std::string &network : networks) {
+    for (const std::string &fleet : fleets) {
+      BatchScenario scenario = base;
+      scenario.networkPath = network;
+      scenario.trains = std::atoi(fleet.c_str());
+      scenario.name = network + " trains=" + fleet;
+
+      BatchSummary summary;
+      try {
+        summary = runner.run(scenario, firstSeed, runs);
+      } catch (const std::runtime_error &e) {
+        std::cerr << "batch: " << scenario.name << ": " << e.what()
+                  << std::endl;
+        return 1;
+      }
+      printSummary(summary, runner.getThreadCount());
+
+      if (csv.is_open()) {
+        for (size_t i = 0; i < summary.results.size(); ++i) {
+          const RunResult &r = summary.results[i];
+          csv << network << "," << scenario.trains << "," << summary.seeds[i]
+              << "," << r.score << "," << r.passengers << "," << r.completed
+              << "," << (r.allArrived ? 1 : 0) << "," << r.simMs << "\n";
+        }
+      }
+    }
+  }
+
+  if (csv.is_open() && !csv.flush()) {
+    std::cerr << "batch: could not write " << csvPath << std::endl;
+    return 1;
+  }
+  return 0;
+}
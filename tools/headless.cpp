@@ -0,0 +1,5 @@
+// Standalone entry point for the headless simulator. Links only against the
+// simulation library, so it runs on machines without a display or GPU.
+#include "util/Headless.h"
+
+int main(int argc, char *argv[]) { return runHeadless(argc, argv); }
@@ -0,0 +1,102 @@
+// Converts an event journal written with --journal to CSV, one event per
+// line with station names resolved from the network it was recorded on.
+//
+//   ./athens-metro-journal RUN.journal [--network=FILE] [--out=FILE]
+//
+// Without --network stations are written as ids. Without --out the CSV
+// goes to standard output.
+#include "util/CommandLine.h"
+#include "util/Journal.h"
+#include "util/NetworkLoader.h"
+#include "util/Simulation.h"
+#include <cstdio>
+#include <iostream>
+#include <stdexcept>
+#include <string>
+
+int main(int argc, char *argv[]) {
+  std::string journalPath;
+  for (int i = 1; i < argc; ++i) {
+    if (argv[i][0] != '-') {
+      journalPath = argv[i];
+      break;
+    }
+  }
+  if (journalPath.empty()) {
+    std::cerr << "usage: athens-metro-journal RUN.journal [--network=FILE] "
+                 "[--out=FILE]"
+              << std::endl;
+    return 1;
+  }
+  std::string networkPath = getArgValue(argc, argv, "--network");
+  std::string outPath = getArgValue(argc, argv, "--out");
+
+  Simulation sim;
+  if (!networkPath.empty()) {
+    try {
+      loadNetwork(sim, networkPath, 800, 600);
+    } catch (const std::runtime_error &e) {
+      std::cerr << "journal: " << e.what() << std::endl;
+      return 1;
+    }
+  }
+
+  std::FILE *out = outPath.empty() ? stdout : std::fopen(outPath.c_str(), "w");
+  if (!out) {
+    std::cerr << "journal: could not open " << outPath << std::endl;
+    return 1;
+  }
+
+  // Station column: name if known and quoted, else the bare id
+  auto writeStation = [&](int station) {
+    if (station >= 0 && station < (int)sim.getStations().size()) {
+      std::fputc('"', out);
+      for (char c : sim.getStationName(station)) {
+        if (c == '"')
+          std::fputc('"', out);
+        std::fputc(c, out);
+      }
+      std::fputc('"', out);
+    } else if (station >= 0) {
+      std::fprintf(out, "%d", station);
+    }
+  };
+  auto writeId = [&](int id) {
+    if (id >= 0)
+      std::fprintf(out, "%d", id);
+  };
+
+  uint64_t count = 0;
+  std::fputs("time_ms,event,passenger,train,station,destination,score\n", out);
+  try {
+    count = readJournal(journalPath, [&](const JournalEvent &event) {
+      std::fprintf(out, "%llu,%s,", (unsigned long long)event.timeMs,
+                   journalEventName(event.type));
+      writeId(event.passenger);
+      std::fputc(',', out);
+      writeId(event.train);
+      std::fputc(',', out);
+      writeStation(event.station);
+      std::fputc(',', out);
+      if (event.type == JournalEvent::SPAWN)
+        writeStation(event.value);
+      std::fputc(',', out);
+      if (event.type == JournalEvent::SCORE)
+        std::fprintf(out, "%d", event.value);
+      std::fputc('\n', out);
+    });
+  } catch (const std::runtime_error &e) {
+    std::cerr << "journal: " << e.what() << std::endl;
+    return 1;
+  }
+
+  bool ok = std::fflush(out) == 0;
+  if (out != stdout)
+    ok = std::fclose(out) == 0 && ok;
+  if (!ok) {
+    std::cerr << "journal: could not write " << outPath << std::endl;
+    return 1;
+  }
+  std::cerr << "Converted " << count << " events" << std::endl;
+  return 0;
+}
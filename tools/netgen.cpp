@@ -0,0 +1,72 @@
+// Synthetic network generator. Writes a network in the same JSON schema as
+// assets/metro3.json, for stress testing the loader and the simulation.
+//
+//   ./athens-metro-netgen --topology=grid|radial|scale-free --stations=N
+//                         [--seed=N] [--coords] [--out=FILE]
+//                         [--lines=N] [--ring-every=N]   (radial)
+//                         [--degree=N]                   (scale-free)
+//                         [--width=W] [--height=H]       (coordinate area)
+//
+// Without --out the network goes to standard output. A summary is printed
+// to standard error.
+#include "util/CommandLine.h"
+#include "util/NetworkGen.h"
+#include <chrono>
+#include <cstdlib>
+#include <fstream>
+#include <iostream>
+#include <stdexcept>
+#include <string>
+
+int main(int argc, char *argv[]) {
+  NetworkGenOptions options;
+  options.topology = getArgValue(argc, argv, "--topology", "grid");
+  options.stations =
+      std::atoi(getArgValue(argc, argv, "--stations", "100").c_str());
+  options.seed =
+      std::strtoull(getArgValue(argc, argv, "--seed", "1").c_str(), nullptr, 10);
+  options.lines = std::atoi(getArgValue(argc, argv, "--lines", "8").c_str());
+  options.ringEvery =
+      std::atoi(getArgValue(argc, argv, "--ring-every", "4").c_str());
+  options.degree = std::atoi(getArgValue(argc, argv, "--degree", "2").c_str());
+  options.width = (float)std::atof(getArgValue(argc, argv, "--width", "800").c_str());
+  options.height =
+      (float)std::atof(getArgValue(argc, argv, "--height", "600").c_str());
+  bool coordinates = hasArg(argc, argv, "--coords");
+  std::string outPath = getArgValue(argc, argv, "--out");
+
+  auto start = std::chrono::steady_clock::now();
+  GeneratedNetwork network;
+  try {
+    network = generateNetwork(options);
+  } catch (const std::invalid_argument &e) {
+    std::cerr << "netgen: " << e.what() << std::endl;
+    return 1;
+  }
+
+  if (outPath.empty()) {
+    std::ios::sync_with_stdio(false);
+    writeNetworkJson(network, std::cout, coordinates);
+    std::cout.flush();
+  } else {
+    std::ofstream file(outPath, std::ios::binary);
+    if (!file) {
+      std::cerr << "netgen: could not open " << outPath << std::endl;
+      return 1;
+    }
+    writeNetworkJson(network, file, coordinates);
+    if (!file.flush()) {
+      std::cerr << "netgen: could not write " << outPath << std::endl;
+      return 1;
+    }
+  }
+
+  double seconds = std::chrono::duration<double>(
+                       std::chrono::steady_clock::now() - start)
+                       .count();
+  std::cerr << "Generated " << options.topology << " network: "
+            << network.stationCount << " stations, "
+            << network.getEdgeCount() << " connections (seed "
+            << options.seed << ") in " << seconds << " s" << std::endl;
+  return 0;
+}
@@ -0,0 +1,107 @@
+#include "BatchRunner.h"
+#include "Dispatch.h"
+#include "NetworkLoader.h"
+#include "Profiler.h"
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <exception>
+#include <stdexcept>
+#include <thread>
+
+SampleStats SampleStats::of(std::vector<double> values) {
+  SampleStats stats;
+  if (values.empty())
+    return stats;
+  std::sort(values.begin(), values.end());
+  double sum = 0.0;
+  for (double v : values)
+    sum += v;
+  auto at = [&](double p) {
+    return values[(size_t)(p / 100.0 * (double)(values.size() - 1) + 0.5)];
+  };
+  stats.mean = sum / (double)values.size();
+  stats.min = values.front();
+  stats.max = values.back();
+  stats.p50 = at(50.0);
+  stats.p90 = at(90.0);
+  stats.p99 = at(99.0);
+  return stats;
+}
+
+static int defaultThreads(int threads) {
+  if (threads > 0)
+    return threads;
+  unsigned hardware = std::thread::hardware_concurrency();
+  return hardware > 0 ? (int)hardware : 1;
+}
+
+BatchRunner::BatchRunner(int threads) : pool(defaultThreads(threads)) {}
+
+BatchSummary BatchRunner::run(const BatchScenario &scenario,
+                              uint64_t firstSeed, int runs) {
+  ProfileScope scope("batch");
+  auto wallStart = std::chrono::steady_clock::now();
+
+  if (!makeDispatchPolicy(scenario.dispatch))
+    throw std::runtime_error("Unknown dispatch policy '" + scenario.dispatch +
+                             "'");
+  NetworkImage image =
+      loadNetworkImage(scenario.networkPath, kDefaultNetworkCacheDir);
+
+  BatchSummary summary;
+  summary.scenario = scenario;
+  runs = std::max(runs, 0);
+  summary.seeds.resize(runs);
+  summary.results.resize(runs);
+
+  // One slot per worker, each pulling run indices until none are left
+  int workers = getThreadCount();
+  std::atomic<int> nextRun(0);
+  std::vector<Histogram> waits(workers);
+  std::vector<std::exception_ptr> errors(workers);
+  pool.parallelFor(workers, 1, [&](size_t, size_t, int worker) {
+    try {
+      for (int i = nextRun++; i < runs; i = nextRun++) {
+        uint64_t seed = firstSeed + (uint64_t)i;
+        Simulation sim;
+        sim.setSeed(seed);
+        sim.setDispatchPolicy(makeDispatchPolicy(scenario.dispatch));
+        sim.setEngine(scenario.engine);
+        sim.setLineSpeed(scenario.lineSpeed);
+        loadNetwork(sim, image, 800, 600);
+        setupScenario(sim, scenario.trains, scenario.riders);
+        setupDemand(sim, scenario.demand);
+
+        summary.seeds[i] = seed;
+        summary.results[i] = sim.runUntilDone(scenario.maxSimMs);
+        waits[worker].merge(sim.getWaitTimes());
+      }
+    } catch (...) {
+      errors[worker] = std::current_exception();
+      nextRun = runs; // stop the other workers early
+    }
+  });
+  for (const std::exception_ptr &error : errors) {
+    if (error)
+      std::rethrow_exception(error);
+  }
+
+  std::vector<double> scores;
+  std::vector<double> completions;
+  for (const RunResult &result : summary.results) {
+    scores.push_back(result.score);
+    completions.push_back((double)result.simMs);
+    if (result.allArrived)
+      summary.finishedRuns++;
+  }
+  summary.score = SampleStats::of(scores);
+  summary.completionMs = SampleStats::of(completions);
+  for (const Histogram &histogram : waits)
+    summary.waitTimes.merge(histogram);
+
+  summary.wallSeconds = std::chrono::duration<double>(
+                            std::chrono::steady_clock::now() - wallStart)
+                            .count();
+  return summary;
+}
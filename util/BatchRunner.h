@@ -0,0 +1,87 @@
+#ifndef BATCH_RUNNER_H
+#define BATCH_RUNNER_H
+
+#include "Histogram.h"
+#include "Scenario.h"
+#include "Simulation.h"
+#include "WorkerPool.h"
+#include <cstdint>
+#include <string>
+#include <vector>
+
+/**
+ * @brief One what-if configuration for BatchRunner: a network and fleet,
+ * run once per seed
+ */
+struct BatchScenario {
+  std::string name; // label for reports
+  std::string networkPath = "assets/metro3.json";
+  int trains = 3;
+  int riders = 20; // spawned at the start, as in setupScenario()
+  std::string dispatch = "demand";
+  DemandOptions demand;
+  Simulation::Engine engine = Simulation::EVENT_DRIVEN;
+  float lineSpeed = Simulation::kDefaultLineSpeed;
+  long long maxSimMs = 24LL * 60 * 60 * 1000;
+};
+
+/**
+ * @brief Mean, extremes and percentiles of a set of values
+ */
+struct SampleStats {
+  double mean = 0.0;
+  double min = 0.0;
+  double max = 0.0;
+  double p50 = 0.0;
+  double p90 = 0.0;
+  double p99 = 0.0;
+
+  static SampleStats of(std::vector<double> values);
+};
+
+/**
+ * @brief Outcome of every run of one scenario
+ */
+struct BatchSummary {
+  BatchScenario scenario;
+  std::vector<uint64_t> seeds;     // in run order
+  std::vector<RunResult> results;  // parallel to seeds
+  int finishedRuns = 0;            // runs where everyone arrived
+  SampleStats score;
+  SampleStats completionMs;        // simulated time each run ended at
+  Histogram waitTimes;             // every boarding of every run, ms
+  double wallSeconds = 0.0;
+};
+
+/**
+ * @brief Runs many seeded simulations of a scenario at once, one per
+ * thread, and aggregates their results.
+ *
+ * Each run owns its own Simulation, so runs share nothing but the network
+ * image, which is compiled (or mapped from the cache) once per scenario
+ * and only read afterwards. Workers take the next unstarted run as they
+ * finish one, so long and short runs balance out; results are stored by
+ * run index, so the summary does not depend on the thread count.
+ */
+class BatchRunner {
+public:
+  /**
+   * @param threads Concurrent runs; 0 uses every hardware thread
+   */
+  explicit BatchRunner(int threads = 0);
+
+  int getThreadCount() const { return pool.size(); }
+
+  /**
+   * @brief Run a scenario with seeds firstSeed, firstSeed + 1, ...
+   * @throws std::runtime_error if the network, demand or dispatch policy
+   * cannot be set up
+   */
+  BatchSummary run(const BatchScenario &scenario, uint64_t firstSeed,
+                   int runs);
+
+private:
+  WorkerPool pool;
+};
+
+#endif // BATCH_RUNNER_H
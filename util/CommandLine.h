@@ -0,0 +1,47 @@
+#ifndef COMMAND_LINE_H
+#define COMMAND_LINE_H
+
+#include <cstdint>
+#include <cstdlib>
+#include <random>
+#include <string>
+
+/**
+ * @brief Check whether a bare flag (e.g. "-DEBUG") was passed
+ */
+inline bool hasArg(int argc, char *argv[], const std::string &flag) {
+  for (int i = 1; i < argc; ++i) {
+    if (flag == argv[i])
+      return true;
+  }
+  return false;
+}
+
+/**
+ * @brief Look up the value of a "--key=value" argument
+ * @param key Argument name including the leading dashes, e.g. "--seed"
+ * @param fallback Returned when the argument is absent
+ */
+inline std::string getArgValue(int argc, char *argv[], const std::string &key,
+                               const std::string &fallback = "") {
+  std::string prefix = key + "=";
+  for (int i = 1; i < argc; ++i) {
+    std::string arg = argv[i];
+    if (arg.rfind(prefix, 0) == 0)
+      return arg.substr(prefix.size());
+  }
+  return fallback;
+}
+
+/**
+ * @brief Run seed from "--seed=N", or a fresh random one if absent
+ */
+inline uint64_t getSeedArg(int argc, char *argv[]) {
+  std::string value = getArgValue(argc, argv, "--seed");
+  if (!value.empty())
+    return std::strtoull(value.c_str(), nullptr, 10);
+  std::random_device rd;
+  return ((uint64_t)rd() << 32) | rd();
+}
+
+#endif // COMMAND_LINE_H
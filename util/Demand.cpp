@@ -0,0 +1,257 @@
+#include "Demand.h"
+#include "Simulation.h"
+#include <algorithm>
+#include <cmath>
+#include <cstdlib>
+#include <fstream>
+#include <sstream>
+#include <stdexcept>
+
+DemandProfile DemandProfile::flat() {
+  DemandProfile p;
+  for (float &h : p.hourly)
+    h = 1.0f;
+  return p;
+}
+
+DemandProfile DemandProfile::commuter() {
+  static const float shape[24] = {
+      0.1f, 0.05f, 0.05f, 0.05f, 0.1f, 0.3f,  // 00-06
+      0.7f, 1.8f,  2.0f,  1.2f,  0.8f, 0.8f,  // 06-12
+      0.9f, 0.8f,  0.8f,  0.9f,  1.3f, 1.9f,  // 12-18
+      1.7f, 1.0f,  0.7f,  0.5f,  0.3f, 0.2f}; // 18-24
+  DemandProfile p;
+  for (int i = 0; i < 24; ++i)
+    p.hourly[i] = shape[i];
+  return p;
+}
+
+bool DemandProfile::byName(const std::string &name, DemandProfile &out) {
+  if (name == "flat")
+    out = flat();
+  else if (name == "commuter")
+    out = commuter();
+  else
+    return false;
+  return true;
+}
+
+float DemandProfile::peak() const {
+  float best = 0.0f;
+  for (float h : hourly)
+    best = h > best ? h : best;
+  return best;
+}
+
+DemandModel::DemandModel(int stationCount)
+    : background(stationCount, 0.0), flows(stationCount),
+      profiles(1, DemandProfile::flat()), profileOf(stationCount, 0) {}
+
+void DemandModel::setBackgroundRate(int origin, double ridersPerHour) {
+  background[origin] = ridersPerHour > 0.0 ? ridersPerHour : 0.0;
+}
+
+void DemandModel::setBackgroundRate(double ridersPerHour) {
+  for (int o = 0; o < getStationCount(); ++o)
+    setBackgroundRate(o, ridersPerHour);
+}
+
+void DemandModel::addFlow(int origin, int destination, double ridersPerHour) {
+  if (origin == destination || ridersPerHour <= 0.0)
+    return;
+  for (auto &flow : flows[origin]) {
+    if (flow.first == destination) {
+      flow.second += ridersPerHour;
+      return;
+    }
+  }
+  flows[origin].push_back(std::make_pair(destination, ridersPerHour));
+}
+
+int DemandModel::addProfile(const DemandProfile &profile) {
+  profiles.push_back(profile);
+  return (int)profiles.size() - 1;
+}
+
+void DemandModel::setProfile(int origin, int profileId) {
+  profileOf[origin] = profileId;
+}
+
+void DemandModel::setProfile(const DemandProfile &profile) {
+  profiles.assign(1, profile);
+  profileOf.assign(profileOf.size(), 0);
+}
+
+double DemandModel::getOriginRate(int origin) const {
+  double rate = background[origin];
+  for (const auto &flow : flows[origin])
+    rate += flow.second;
+  return rate;
+}
+
+void DemandModel::loadFlows(const Simulation &sim, const std::string &path) {
+  std::ifstream file(path);
+  if (!file)
+    throw std::runtime_error("Could not open " + path);
+
+  std::string line;
+  int lineNumber = 0;
+  while (std::getline(file, line)) {
+    lineNumber++;
+    if (!line.empty() && line.back() == '\r')
+      line.pop_back();
+    if (line.empty() || line[0] == '#')
+      continue;
+
+    std::istringstream fields(line);
+    std::string origin, destination, rate;
+    if (!std::getline(fields, origin, ',') ||
+        !std::getline(fields, destination, ',') ||
+        !std::getline(fields, rate))
+      throw std::runtime_error(path + ":" + std::to_string(lineNumber) +
+                               ": expected origin,destination,riders_per_hour");
+
+    int from = sim.findStation(origin);
+    int to = sim.findStation(destination);
+    if (from < 0 || to < 0)
+      throw std::runtime_error(path + ":" + std::to_string(lineNumber) +
+                               ": unknown station '" +
+                               (from < 0 ? origin : destination) + "'");
+    char *end = nullptr;
+    double ridersPerHour = std::strtod(rate.c_str(), &end);
+    if (end == rate.c_str())
+      throw std::runtime_error(path + ":" + std::to_string(lineNumber) +
+                               ": invalid rate '" + rate + "'");
+    addFlow(from, to, ridersPerHour);
+  }
+}
+
+void AliasTable::build(const std::vector<double> &weights) {
+  size_t n = weights.size();
+  prob.assign(n, 0.0f);
+  alias.assign(n, 0);
+  double total = 0.0;
+  for (double w : weights)
+    total += w;
+  if (n == 0 || total <= 0.0) {
+    prob.clear();
+    alias.clear();
+    return;
+  }
+
+  // Vose: pair each under-full column with an over-full one
+  std::vector<double> scaled(n);
+  std::vector<uint32_t> small, large;
+  for (size_t i = 0; i < n; ++i) {
+    scaled[i] = weights[i] * (double)n / total;
+    (scaled[i] < 1.0 ? small : large).push_back((uint32_t)i);
+  }
+  while (!small.empty() && !large.empty()) {
+    uint32_t s = small.back();
+    small.pop_back();
+    uint32_t l = large.back();
+    prob[s] = (float)scaled[s];
+    alias[s] = l;
+    scaled[l] -= 1.0 - scaled[s];
+    if (scaled[l] < 1.0) {
+      large.pop_back();
+      small.push_back(l);
+    }
+  }
+  // Whatever is left is full up to rounding
+  for (uint32_t i : large)
+    prob[i] = 1.0f;
+  for (uint32_t i : small)
+    prob[i] = 1.0f;
+}
+
+DemandGenerator::DemandGenerator(const DemandModel &model, Rng stream,
+                                 long long startOfDay)
+    : totalPeakRate(0.0), rng(stream), startOfDayMs(startOfDay), endMs(-1),
+      nextArrivalMs(0.0), spawned(0), unroutable(0) {
+  int n = model.getStationCount();
+  origins.resize(n);
+  std::vector<double> originWeights(n);
+  std::vector<double> weights;
+
+  for (int o = 0; o < n; ++o) {
+    Origin &origin = origins[o];
+    const DemandProfile &profile = model.getProfile(o);
+    origin.profile = -1;
+    for (size_t p = 0; p < profiles.size(); ++p) {
+      if (std::equal(profile.hourly, profile.hourly + 24, profiles[p].hourly))
+        origin.profile = (int)p;
+    }
+    if (origin.profile < 0) {
+      origin.profile = (int)profiles.size();
+      profiles.push_back(profile);
+    }
+    origin.peak = profile.peak();
+
+    const auto &flows = model.getFlows(o);
+    if (!flows.empty()) {
+      weights.assign(1, n > 1 ? model.getBackgroundRate(o) : 0.0);
+      for (const auto &flow : flows) {
+        origin.flowTargets.push_back(flow.first);
+        weights.push_back(flow.second);
+      }
+      origin.destinations.build(weights);
+    }
+
+    // An origin whose profile is zero all day never sends anyone
+    double rate = n > 1 || !flows.empty() ? model.getOriginRate(o) : 0.0;
+    originWeights[o] = origin.peak > 0.0f ? rate * origin.peak : 0.0;
+    totalPeakRate += originWeights[o];
+  }
+
+  originTable.build(originWeights);
+  totalPeakRate /= 60.0 * 60.0 * 1000.0; // per hour -> per ms
+  scheduleNext();
+}
+
+void DemandGenerator::scheduleNext() {
+  if (totalPeakRate <= 0.0)
+    return;
+  // Exponential gap; 1 - u is in (0, 1], so the log is finite
+  nextArrivalMs += -std::log(1.0 - rng.nextDouble()) / totalPeakRate;
+}
+
+int DemandGenerator::pickDestination(int o, int stationCount) {
+  const Origin &origin = origins[o];
+  if (!origin.destinations.empty()) {
+    uint32_t k = origin.destinations.sample(rng);
+    if (k > 0)
+      return origin.flowTargets[k - 1];
+  }
+  // Background: any station but the origin
+  int d = (int)rng.nextBelow((uint32_t)stationCount - 1);
+  return d >= o ? d + 1 : d;
+}
+
+void DemandGenerator::generate(Simulation &sim, long long nowMs) {
+  if (totalPeakRate <= 0.0)
+    return;
+  int stationCount = (int)sim.getStations().size();
+  long long limit = endMs >= 0 && endMs < nowMs ? endMs : nowMs;
+
+  while (nextArrivalMs <= (double)limit) {
+    long long at = (long long)nextArrivalMs;
+    scheduleNext();
+
+    int o = (int)originTable.sample(rng);
+    const Origin &origin = origins[o];
+    if (origin.peak <= 0.0f)
+      continue; // never picked, but keep the division below safe
+    float keep = profiles[origin.profile].at(startOfDayMs + at) / origin.peak;
+    if (keep < 1.0f && rng.nextFloat() >= keep)
+      continue; // thinned: off-peak hour for this origin
+
+    int d = pickDestination(o, stationCount);
+    if (!sim.getRoutes().isReachable(o, d)) {
+      unroutable++;
+      continue;
+    }
+    sim.addPassenger(o, d);
+    spawned++;
+  }
+}
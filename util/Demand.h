@@ -0,0 +1,194 @@
+#ifndef DEMAND_H
+#define DEMAND_H
+
+#include "Rng.h"
+#include <cstdint>
+#include <string>
+#include <utility>
+#include <vector>
+
+class Simulation;
+
+/**
+ * @brief How demand varies over a day: one rate multiplier per hour
+ */
+struct DemandProfile {
+  float hourly[24];
+
+  /// The same rate around the clock
+  static DemandProfile flat();
+  /// Quiet nights, with morning (07-09) and evening (17-19) peaks
+  static DemandProfile commuter();
+
+  /**
+   * @brief Profile by name ("flat" or "commuter")
+   * @return false if the name is unknown
+   */
+  static bool byName(const std::string &name, DemandProfile &out);
+
+  static constexpr long long kDayMs = 24LL * 60 * 60 * 1000;
+
+  /// Multiplier at a time of day (wrapped to one day, also before 00:00)
+  float at(long long dayMs) const {
+    long long t = (dayMs % kDayMs + kDayMs) % kDayMs;
+    return hourly[t / (60LL * 60 * 1000)];
+  }
+  float peak() const;
+};
+
+/**
+ * @brief Origin-destination rate matrix, in riders per hour at a profile
+ * multiplier of 1.
+ *
+ * Each origin has a background rate spread evenly over every other station,
+ * plus any number of explicit flows to particular destinations. The matrix
+ * is stored sparsely, so a network of n stations costs O(n + flows) rather
+ * than O(n^2). Each origin follows one of the model's time-of-day profiles
+ * (profile 0, flat, unless set otherwise).
+ */
+class DemandModel {
+public:
+  explicit DemandModel(int stationCount = 0);
+
+  int getStationCount() const { return (int)background.size(); }
+
+  /// Background rate of one origin, or of every origin
+  void setBackgroundRate(int origin, double ridersPerHour);
+  void setBackgroundRate(double ridersPerHour);
+
+  /// Add an explicit flow (added to any existing flow for the same pair)
+  void addFlow(int origin, int destination, double ridersPerHour);
+
+  /// Register a profile; returns its id
+  int addProfile(const DemandProfile &profile);
+  void setProfile(int origin, int profileId);
+  /// Use one profile for every origin
+  void setProfile(const DemandProfile &profile);
+
+  /**
+   * @brief Add the flows listed in a CSV file, one
+   * "origin,destination,riders_per_hour" line per flow, by station name.
+   * Blank lines and lines starting with '#' are ignored.
+   * @throws std::runtime_error if the file cannot be read, a line is
+   * malformed or names an unknown station
+   */
+  void loadFlows(const Simulation &sim, const std::string &path);
+
+  double getBackgroundRate(int origin) const { return background[origin]; }
+  const std::vector<std::pair<int, double>> &getFlows(int origin) const {
+    return flows[origin];
+  }
+  const DemandProfile &getProfile(int origin) const {
+    return profiles[profileOf[origin]];
+  }
+
+  /// Riders per hour leaving an origin at a profile multiplier of 1
+  double getOriginRate(int origin) const;
+
+private:
+  std::vector<double> background;
+  std::vector<std::vector<std::pair<int, double>>> flows;
+  std::vector<DemandProfile> profiles;
+  std::vector<int> profileOf;
+};
+
+/**
+ * @brief Walker/Vose alias table: draws index i with probability
+ * weight[i] / sum(weights) in O(1)
+ */
+class AliasTable {
+public:
+  void build(const std::vector<double> &weights);
+  bool empty() const { return prob.empty(); }
+  size_t size() const { return prob.size(); }
+
+  uint32_t sample(Rng &rng) const {
+    uint32_t i = rng.nextBelow((uint32_t)prob.size());
+    return rng.nextFloat() < prob[i] ? i : alias[i];
+  }
+
+private:
+  std::vector<float> prob;
+  std::vector<uint32_t> alias;
+};
+
+/**
+ * @brief Spawns passengers as Poisson arrivals following a DemandModel.
+ *
+ * Arrivals at each origin are a non-homogeneous Poisson process whose rate
+ * is the origin's rate times its profile. Rather than keeping a timer per
+ * origin, the generator runs one Poisson stream at the sum of every
+ * origin's peak rate and splits it: each arrival picks its origin from an
+ * alias table weighted by peak rate, and is kept with probability
+ * profile(t) / peak (thinning). The superposition of the per-origin
+ * processes is exactly this one stream, so the cost per arrival is O(1)
+ * whatever the network size, and nothing is done on ticks with no
+ * arrival.
+ *
+ * Arrivals are timed in simulated milliseconds and spawned on the tick
+ * they fall in, so a seed gives the same riders at any time warp or thread
+ * count.
+ */
+class DemandGenerator {
+public:
+  /**
+   * @param model Rates and profiles; copied into the generator's tables
+   * @param rng Stream to draw arrivals from (see Rng::DEMAND)
+   * @param startOfDayMs Time of day at simulated time 0
+   */
+  DemandGenerator(const DemandModel &model, Rng rng,
+                  long long startOfDayMs = 0);
+
+  /**
+   * @brief Stop generating at this simulated time (-1, the default, never
+   * stops)
+   */
+  void setEndMs(long long ms) { endMs = ms; }
+  long long getEndMs() const { return endMs; }
+
+  /**
+   * @brief Spawn every arrival due up to and including simulated time nowMs
+   */
+  void generate(Simulation &sim, long long nowMs);
+
+  /**
+   * @brief Whether no more riders will ever be generated
+   */
+  bool isFinished(long long nowMs) const {
+    return totalPeakRate <= 0.0 || (endMs >= 0 && nowMs >= endMs);
+  }
+
+  /**
+   * @brief Simulated time of the next candidate arrival. It may still be
+   * thinned away, but no rider appears before it.
+   */
+  double getNextArrivalMs() const { return nextArrivalMs; }
+
+  /// Riders spawned, and arrivals dropped because there was no route
+  long long getSpawned() const { return spawned; }
+  long long getUnroutable() const { return unroutable; }
+
+private:
+  struct Origin {
+    int profile;
+    float peak; // profile peak, for thinning
+    AliasTable destinations; // entry 0: background, k > 0: flowTargets[k - 1]
+    std::vector<int> flowTargets; // empty: background only
+  };
+
+  std::vector<DemandProfile> profiles;
+  std::vector<Origin> origins;
+  AliasTable originTable; // by peak rate
+  double totalPeakRate;   // arrivals per ms, all origins at their peak
+  Rng rng;
+  long long startOfDayMs;
+  long long endMs;
+  double nextArrivalMs;
+  long long spawned;
+  long long unroutable;
+
+  void scheduleNext();
+  int pickDestination(int origin, int stationCount);
+};
+
+#endif // DEMAND_H
@@ -0,0 +1,203 @@
+#include "Dispatch.h"
+#include "Simulation.h"
+#include <algorithm>
+#include <unordered_set>
+
+int RandomWalkPolicy::pickNext(const Simulation &sim, int trainId, Rng &rng) {
+  const SimTrain &train = sim.getTrain(trainId);
+  if (train.currentStation < 0)
+    return -1;
+  const std::vector<int> &connections =
+      sim.getStation(train.currentStation).next;
+  if (connections.empty())
+    return -1;
+
+  // Randomly pick a connection other than the one we came from
+  int valid = 0;
+  for (int s : connections) {
+    if (s != train.previousStation)
+      valid++;
+  }
+
+  // If dead end (only connection is previous), go back
+  if (valid == 0)
+    return connections[rng.nextBelow((uint32_t)connections.size())];
+
+  int pick = (int)rng.nextBelow((uint32_t)valid);
+  for (int s : connections) {
+    if (s != train.previousStation && pick-- == 0)
+      return s;
+  }
+  return -1;
+}
+
+int DemandWeightedPolicy::pickNext(const Simulation &sim, int trainId,
+                                   Rng &rng) {
+  const SimTrain &train = sim.getTrain(trainId);
+  if (train.currentStation < 0)
+    return -1;
+  const SimStation &here = sim.getStation(train.currentStation);
+  const PassengerStore &passengers = sim.getPassengers();
+  int freeSeats = train.capacity - (int)train.passengers.size();
+
+  const RoutingTable &routes = sim.getRoutes();
+
+  int best = -1;
+  int bestDemand = 0;
+  uint32_t ties = 0;
+  for (int k = 0; k < (int)here.next.size(); ++k) {
+    int n = here.next[k];
+    int demand = 0;
+    for (int pid : train.passengers) {
+      if (routes.nextHopSlot(train.currentStation,
+                             passengers.getDestination(pid)) == k)
+        demand += 2;
+    }
+    int boarders = (int)here.waitingByHop[k].size();
+    demand += (boarders < freeSeats ? boarders : freeSeats) +
+              sim.getWaitingForDispatch(n);
+
+    if (demand > bestDemand) {
+      best = n;
+      bestDemand = demand;
+      ties = 1;
+    } else if (demand == bestDemand && demand > 0 &&
+               rng.nextBelow(++ties) == 0) {
+      // Reservoir sampling keeps ties uniformly random
+      best = n;
+    }
+  }
+
+  if (best < 0) {
+    RandomWalkPolicy fallback;
+    return fallback.pickNext(sim, trainId, rng);
+  }
+  return best;
+}
+
+int ShuttlePolicy::pickNext(const Simulation &sim, int trainId, Rng &rng) {
+  const SimTrain &train = sim.getTrain(trainId);
+  if (train.currentStation < 0)
+    return -1;
+  if ((int)lines.size() <= trainId)
+    lines.resize(trainId + 1);
+
+  Line &line = lines[trainId];
+  if (line.stops.empty()) {
+    // Farthest station (in stops) from where the train starts
+    int start = train.currentStation;
+    int stationCount = (int)sim.getStations().size();
+    std::vector<int> dist(stationCount, -1);
+    std::vector<int> queue;
+    queue.reserve(stationCount);
+    queue.push_back(start);
+    dist[start] = 0;
+    int far = start;
+    for (size_t head = 0; head < queue.size(); ++head) {
+      int v = queue[head];
+      if (dist[v] > dist[far])
+        far = v;
+      for (int n : sim.getStation(v).next) {
+        if (dist[n] < 0) {
+          dist[n] = dist[v] + 1;
+          queue.push_back(n);
+        }
+      }
+    }
+
+    // Out along the shortest route to the far end, and back along the
+    // shortest route from it, which on a directed network is another one
+    auto walk = [&](int from, int to) {
+      for (int at = from; at != to;) {
+        at = sim.nextHop(at, to);
+        if (at < 0)
+          return false;
+        line.stops.push_back(at);
+      }
+      return true;
+    };
+    line.stops.push_back(start);
+    walk(start, far);
+    size_t outbound = line.stops.size();
+    line.closed = walk(far, start);
+    if (!line.closed)
+      line.stops.resize(outbound);
+    else if (line.stops.size() > outbound)
+      line.stops.pop_back(); // back at the start, which is stops[0]
+    line.index = 0;
+  }
+
+  int count = (int)line.stops.size();
+  if (count < 2)
+    return -1;
+
+  // A train that left its line picks it up again at the next stop it has
+  // in common with it
+  for (int i = 0; i < count && line.stops[line.index] != train.currentStation;
+       ++i)
+    line.index = (line.index + 1) % count;
+
+  if (line.stops[line.index] == train.currentStation &&
+      (line.closed || line.index + 1 < count)) {
+    int next = line.stops[(line.index + 1) % count];
+    const std::vector<int> &connections =
+        sim.getStation(train.currentStation).next;
+    if (std::find(connections.begin(), connections.end(), next) !=
+        connections.end()) {
+      line.index = (line.index + 1) % count;
+      return next;
+    }
+  }
+
+  DemandWeightedPolicy fallback;
+  return fallback.pickNext(sim, trainId, rng);
+}
+
+int ShuttlePolicy::countStranded(const Simulation &sim) const {
+  // Every connection some train runs along
+  std::unordered_set<uint64_t> legs;
+  auto leg = [](int from, int to) {
+    return (uint64_t)(uint32_t)from << 32 | (uint32_t)to;
+  };
+  for (const Line &line : lines) {
+    int count = (int)line.stops.size();
+    for (int i = 0; i + 1 < count; ++i)
+      legs.insert(leg(line.stops[i], line.stops[i + 1]));
+    if (line.closed && count > 1)
+      legs.insert(leg(line.stops[count - 1], line.stops[0]));
+  }
+
+  // A rider arrives only if every hop of their route is on some line
+  const PassengerStore &passengers = sim.getPassengers();
+  int stranded = 0;
+  for (int s = 0; s < (int)sim.getStations().size(); ++s) {
+    sim.getStation(s).forEachWaiting([&](int pid) {
+      int to = passengers.getDestination(pid);
+      for (int at = s; at != to;) {
+        int hop = sim.nextHop(at, to);
+        if (hop < 0 || !legs.count(leg(at, hop))) {
+          stranded++;
+          return;
+        }
+        at = hop;
+      }
+    });
+  }
+  return stranded;
+}
+
+std::unique_ptr<DispatchPolicy> makeDispatchPolicy(const std::string &name) {
+  if (name == "random")
+    return std::unique_ptr<DispatchPolicy>(new RandomWalkPolicy());
+  if (name == "demand")
+    return std::unique_ptr<DispatchPolicy>(new DemandWeightedPolicy());
+  if (name == "shuttle")
+    return std::unique_ptr<DispatchPolicy>(new ShuttlePolicy());
+  return nullptr;
+}
+
+const std::vector<std::string> &dispatchPolicyNames() {
+  static const std::vector<std::string> names = {"random", "demand",
+                                                 "shuttle"};
+  return names;
+}
@@ -0,0 +1,132 @@
+#ifndef DISPATCH_H
+#define DISPATCH_H
+
+#include "Rng.h"
+#include <memory>
+#include <string>
+#include <vector>
+
+class Simulation;
+
+/**
+ * @brief Decides where a train goes after each stop.
+ *
+ * The Simulation asks its policy for the next station every time a train
+ * leaves a station. Policies only read the simulation; randomness must come
+ * from the train's own Rng stream (passed in) so runs stay reproducible.
+ *
+ * During a tick pickNext() may be called concurrently for trains standing
+ * at different stations. A policy may only write state belonging to the
+ * train it was asked about, and must read other stations' demand through
+ * Simulation::getWaitingForDispatch().
+ */
+class DispatchPolicy {
+public:
+  virtual ~DispatchPolicy() {}
+
+  /**
+   * @brief Short name used on the command line and in reports
+   */
+  virtual const char *getName() const = 0;
+
+  /**
+   * @brief Choose the next station for a train standing at a station
+   * @param sim Simulation the train belongs to
+   * @param trainId Train to dispatch
+   * @param rng The train's random stream
+   * @return Id of a station in the current station's next list, or -1 to
+   * stay put
+   */
+  virtual int pickNext(const Simulation &sim, int trainId, Rng &rng) = 0;
+
+  /**
+   * @brief Called before a batch of possibly concurrent pickNext() calls;
+   * policies with per-train state size it here
+   */
+  virtual void prepare(int trainCount) { (void)trainCount; }
+
+  /**
+   * @brief Forget any per-train state (called when the simulation is cleared)
+   */
+  virtual void reset() {}
+
+  /**
+   * @brief Riders waiting now whose route this policy never runs a train
+   * along, so they can never arrive. Policies that can send a train over
+   * any connection return 0.
+   */
+  virtual int countStranded(const Simulation &sim) const {
+    (void)sim;
+    return 0;
+  }
+};
+
+/**
+ * @brief The original behaviour: a random walk that avoids turning back
+ * unless the train is at a dead end.
+ */
+class RandomWalkPolicy : public DispatchPolicy {
+public:
+  const char *getName() const override { return "random"; }
+  int pickNext(const Simulation &sim, int trainId, Rng &rng) override;
+};
+
+/**
+ * @brief Heads for the neighbour with the most demand.
+ *
+ * Demand for a neighbour n counts onboard riders whose next hop is n (double
+ * weight, they are already paying for the seat), riders on the platform
+ * whose next hop is n (up to the free capacity) and riders waiting at n.
+ * Ties, including "no demand anywhere", fall back to a random walk.
+ */
+class DemandWeightedPolicy : public DispatchPolicy {
+public:
+  const char *getName() const override { return "demand"; }
+  int pickNext(const Simulation &sim, int trainId, Rng &rng) override;
+};
+
+/**
+ * @brief Runs every train round a fixed line.
+ *
+ * The first time a train is dispatched its line is set to the shortest route
+ * from its current station to the station farthest from it, and back again
+ * by the shortest route the other way, so one-way connections are never
+ * taken backwards. The train then loops along it.
+ *
+ * A train that finds its next stop out of reach (the far end has no way
+ * back, or the train left its line) is dispatched by demand instead, and
+ * picks its line up again the next time it stops on it. Stations off every
+ * line are never served; countStranded() reports the riders this strands.
+ */
+class ShuttlePolicy : public DispatchPolicy {
+private:
+  struct Line {
+    std::vector<int> stops; // the loop; the last stop leads to the first
+    bool closed = false;    // whether it does, or the far end is a dead end
+    int index = 0;
+  };
+  std::vector<Line> lines; // indexed by train id
+
+public:
+  const char *getName() const override { return "shuttle"; }
+  int pickNext(const Simulation &sim, int trainId, Rng &rng) override;
+  void prepare(int trainCount) override {
+    if ((int)lines.size() < trainCount)
+      lines.resize(trainCount);
+  }
+  void reset() override { lines.clear(); }
+  int countStranded(const Simulation &sim) const override;
+};
+
+/**
+ * @brief Create a policy by name ("random", "demand" or "shuttle")
+ * @return The policy, or nullptr for an unknown name
+ */
+std::unique_ptr<DispatchPolicy> makeDispatchPolicy(const std::string &name);
+
+/**
+ * @brief Names accepted by makeDispatchPolicy()
+ */
+const std::vector<std::string> &dispatchPolicyNames();
+
+#endif // DISPATCH_H
@@ -1,54 +1,327 @@
 #ifndef GLOBAL_STATE_H
 #define GLOBAL_STATE_H
 
+#include "Handle.h"
+#include "NetworkLayer.h"
+#include "PassengerLayer.h"
+#include "Pool.h"
+#include "Profiler.h"
+#include "SimClock.h"
+#include "SimulateButton.h"
+#include "Simulation.h"
+#include "SpatialGrid.h"
+#include "Station.h"
+#include "Train.h"
 #include "VisualAsset.h"
 #include <atomic>
 #include <chrono>
-#include <fstream>
+#include <cstdio>
+#include <functional>
 #include <iostream>
-#include <json/json.h>
 #include <memory>
+#include <string>
 #include <thread>
+#include <utility>
 #include <vector>
 
 /**
- * @brief Singleton class that manages the global state of the Athens Metro
- * Manager application.
+ * @brief Manages the game state of one Athens Metro Manager window.
  *
  * This class stores the game state (level, score, simulation data) and manages
  * all VisualAsset objects in the game. It provides the central init(),
  * update(), and draw() methods that coordinate all game objects.
+ *
+ * The simulation itself lives in a headless Simulation instance owned here;
+ * the VisualAssets registered with GlobalState are only views over it, and
+ * are handed that Simulation when they are created. Nothing is process-wide,
+ * so a program can hold several states (and simulations) at once; the GUI
+ * keeps one for its window, and headless batches use bare Simulations (see
+ * BatchRunner).
+ *
+ * Assets are created through create<T>(), which constructs them in a typed
+ * Pool and returns a generational Handle; destroy<T>() unlists and releases
+ * them in O(1), and a Handle kept past destroy() no longer resolves.
+ *
+ * Each category loop of update() and draw() is timed with a ProfileScope,
+ * and in debug mode a p50/p99 frame-time overlay is drawn on top.
  */
 class GlobalState {
 
 private:
   int level;
-  std::atomic<int> score;
+  Simulation simulation;
+  NetworkLayer networkLayer; // tracks and station disks, drawn in batches
+  SimClock clock;
+  bool warpKeyDown;
   int windowWidth;
   int windowHeight;
   std::atomic<bool> simulating;
 
-  std::thread score_thread;
-  std::atomic<bool> keep_thread_alive;
+  // End-of-run hook, invoked once when every passenger has arrived
+  std::function<void(const RunResult &)> onRunComplete;
+  bool runComplete;
+  RunResult lastResult;
 
-  // Categorized STL containers to manage visual assets
+  // Typed pools owning every asset
+  Pool<Station> stationPool;
+  Pool<Train> trainPool;
+  Pool<PassengerLayer> passengerPool;
+  Pool<SimulateButton> uiPool;
+
+  // Categorized STL containers listing the assets to update and draw
+  enum AssetList { STATIONS, TRAINS, PASSENGERS, UI_ELEMENTS };
   std::vector<VisualAsset *> stations;
   std::vector<VisualAsset *> trains;
   std::vector<VisualAsset *> passengers;
   std::vector<VisualAsset *> uiElements;
 
-public:
+  std::vector<VisualAsset *> &listFor(int list) {
+    switch (list) {
+    case STATIONS:
+      return stations;
+    case TRAINS:
+      return trains;
+    case PASSENGERS:
+      return passengers;
+    default:
+      return uiElements;
+    }
+  }
+
   /**
-   * @brief Get the singleton instance of GlobalState
-   * @return Reference to the single GlobalState instance
+   * @brief Append an asset to a category list, remembering where it went
    */
-  static GlobalState &getInstance() {
-    static GlobalState instance;
-    return instance;
+  void track(VisualAsset *asset, AssetList list) {
+    std::vector<VisualAsset *> &vec = listFor(list);
+    asset->registryList = list;
+    asset->registryIndex = (int)vec.size();
+    vec.push_back(asset);
   }
 
-  // Delete copy constructor and assignment operator to prevent copying
-  // (singleton class)
+  // Pool and registration per asset type, picked by overload in create()
+  Pool<Station> &poolFor(Station *) { return stationPool; }
+  Pool<Train> &poolFor(Train *) { return trainPool; }
+  Pool<PassengerLayer> &poolFor(PassengerLayer *) { return passengerPool; }
+  Pool<SimulateButton> &poolFor(SimulateButton *) { return uiPool; }
+
+  /**
+   * @brief List a station view and index it for mouse picking
+   */
+  void registerAsset(Station *station) {
+    track(station, STATIONS);
+
+    int id = station->getId();
+    if (id >= (int)stationViews.size())
+      stationViews.resize(id + 1, nullptr);
+    stationViews[id] = station;
+    stationGrid.insert(id, station->getX(), station->getY());
+    if (station->getRadius() > maxStationRadius)
+      maxStationRadius = station->getRadius();
+  }
+  void registerAsset(Train *train) { track(train, TRAINS); }
+  void registerAsset(PassengerLayer *layer) { track(layer, PASSENGERS); }
+  void registerAsset(SimulateButton *button) { track(button, UI_ELEMENTS); }
+
+  // Station views by station id, and a spatial index over their positions
+  // used to route the mouse to a single candidate station per frame
+  std::vector<Station *> stationViews;
+  SpatialGrid stationGrid;
+  float maxStationRadius;
+  Station *hoveredStation;
+
+  /**
+   * @brief What the views last saw of the simulation. Comparing a fresh
+   * snapshot tells whether anything they mirror can have changed.
+   */
+  struct SimSnapshot {
+    long long elapsedMs;
+    uint64_t topology;
+    uint64_t layout;
+    int passengers;
+    int score;
+
+    bool operator==(const SimSnapshot &o) const {
+      return elapsedMs == o.elapsedMs && topology == o.topology &&
+             layout == o.layout && passengers == o.passengers &&
+             score == o.score;
+    }
+    bool operator!=(const SimSnapshot &o) const { return !(*this == o); }
+  };
+
+  SimSnapshot snapshot() const {
+    return SimSnapshot{simulation.getElapsedMs(),
+                       simulation.getTopologyVersion(),
+                       simulation.getLayoutVersion(),
+                       simulation.getTotalPassengers(), simulation.getScore()};
+  }
+
+  // Dirty tracking: station and train/passenger views are only updated
+  // when the simulation moved on since they last ran, and frames where
+  // nothing changed at all are paced down to kIdleFrameMs
+  static constexpr int kIdleFrameMs = 100; // 10 fps while idle
+  static constexpr float kIdleGraceMs = 500.0f;
+  SimSnapshot stationsSeen;
+  SimSnapshot viewsSeen;
+  graphics::MouseState lastMouse;
+  bool frameDirty;
+  float idleMs;
+  std::chrono::steady_clock::time_point lastFrameStart;
+
+  // Frame timing for the debug overlay: the interval between frames and
+  // the time spent inside update() and draw(), in milliseconds
+  static constexpr int kOverlayRefreshFrames = 30;
+  FrameStats frameTimes;
+  FrameStats updateTimes;
+  FrameStats drawTimes;
+  int overlayAge;
+  std::string overlayFrameText;
+  std::string overlayUpdateText;
+  std::string overlayDrawText;
+
+  static std::string percentileText(const char *label,
+                                    const FrameStats &stats) {
+    char text[64];
+    std::snprintf(text, sizeof(text), "%s p50 %.2f ms  p99 %.2f ms", label,
+                  stats.percentile(50.0f), stats.percentile(99.0f));
+    return text;
+  }
+
+  /**
+   * @brief Draw the frame-time percentiles, reformatting them only every
+   * kOverlayRefreshFrames frames
+   */
+  void drawFrameOverlay() {
+    if (overlayAge-- <= 0) {
+      overlayFrameText = percentileText("frame ", frameTimes);
+      overlayUpdateText = percentileText("update", updateTimes);
+      overlayDrawText = percentileText("draw  ", drawTimes);
+      overlayAge = kOverlayRefreshFrames;
+    }
+    graphics::Brush brush;
+    brush.fill_color[0] = 1.0f;
+    brush.fill_color[1] = 0.85f;
+    brush.fill_color[2] = 0.3f;
+    graphics::drawText(520, 100, 13, overlayFrameText, brush);
+    graphics::drawText(520, 118, 13, overlayUpdateText, brush);
+    graphics::drawText(520, 136, 13, overlayDrawText, brush);
+  }
+
+  static float msSince(std::chrono::steady_clock::time_point start) {
+    return std::chrono::duration<float, std::milli>(
+               std::chrono::steady_clock::now() - start)
+        .count();
+  }
+
+  /**
+   * @brief Whether the mouse moved or any button changed since last frame
+   */
+  bool mouseChanged(const graphics::MouseState &mouse) const {
+    return mouse.cur_pos_x != lastMouse.cur_pos_x ||
+           mouse.cur_pos_y != lastMouse.cur_pos_y ||
+           mouse.button_left_down != lastMouse.button_left_down ||
+           mouse.button_middle_down != lastMouse.button_middle_down ||
+           mouse.button_right_down != lastMouse.button_right_down ||
+           mouse.button_left_pressed || mouse.button_left_released ||
+           mouse.button_middle_pressed || mouse.button_middle_released ||
+           mouse.button_right_pressed || mouse.button_right_released;
+  }
+
+  /**
+   * @brief Collect and clear the dirty flags of a group of assets
+   */
+  static bool collectDirty(std::vector<VisualAsset *> &assets) {
+    bool any = false;
+    for (auto *asset : assets) {
+      if (asset && asset->isDirty()) {
+        asset->clearDirty();
+        any = true;
+      }
+    }
+    return any;
+  }
+
+  /**
+   * @brief Sleep out the rest of an idle frame
+   *
+   * SGG clears and redraws the whole canvas every frame, so a frame cannot
+   * be skipped outright. Instead, once nothing has changed for a while, the
+   * update callback stretches the frame to kIdleFrameMs, which lowers the
+   * rate of both update and draw calls.
+   */
+  void paceIdleFrame(float frameMs,
+                     std::chrono::steady_clock::time_point frameStart) {
+    if (frameDirty) {
+      idleMs = 0.0f;
+    } else {
+      idleMs += frameMs;
+      if (idleMs >= kIdleGraceMs) {
+        ProfileScope scope("update.idle");
+        std::this_thread::sleep_until(
+            lastFrameStart + std::chrono::milliseconds(kIdleFrameMs));
+        frameStart = std::chrono::steady_clock::now();
+      }
+    }
+    lastFrameStart = frameStart;
+    frameDirty = false;
+  }
+
+  /**
+   * @brief Route the mouse to the station under the cursor, if any
+   *
+   * A station being dragged keeps the mouse until it is released; otherwise
+   * the grid yields the single station whose disk contains the cursor.
+   */
+  void routeMouseToStations(const graphics::MouseState &mouse) {
+    float mx = graphics::windowToCanvasX((float)mouse.cur_pos_x);
+    float my = graphics::windowToCanvasY((float)mouse.cur_pos_y);
+
+    Station *target = Station::getActiveDraggingStation();
+    if (!target) {
+      int hit = stationGrid.findNearest(mx, my, maxStationRadius);
+      if (hit >= 0 && hit < (int)stationViews.size() && stationViews[hit]) {
+        Station *candidate = stationViews[hit];
+        float dx = mx - candidate->getX();
+        float dy = my - candidate->getY();
+        if (dx * dx + dy * dy < candidate->getRadius() * candidate->getRadius())
+          target = candidate;
+      }
+    }
+
+    if (target != hoveredStation) {
+      if (hoveredStation)
+        hoveredStation->setHovered(false);
+      if (target)
+        target->setHovered(true);
+      hoveredStation = target;
+    }
+
+    if (target && target->getIsActive()) {
+      target->handleMouse(mx, my, mouse);
+      if (target->getIsDragging()) {
+        stationGrid.update(target->getId(), target->getX(), target->getY());
+      }
+    }
+  }
+
+public:
+  GlobalState()
+      : level(0), networkLayer(simulation), clock(Simulation::kFixedStepMs),
+        warpKeyDown(false), windowWidth(800), windowHeight(600),
+        simulating(false), runComplete(false), lastResult(),
+        stationGrid(32.0f), maxStationRadius(0.0f), hoveredStation(nullptr),
+        stationsSeen(), viewsSeen(), lastMouse(), frameDirty(true),
+        idleMs(0.0f), lastFrameStart(std::chrono::steady_clock::now()),
+        overlayAge(0), debugMode(false) {
+    // Force the first frame to update every view
+    stationsSeen.elapsedMs = viewsSeen.elapsedMs = -1;
+  }
+
+  /**
+   * @brief The pools release every visual asset
+   */
+  ~GlobalState() = default;
+
+  // Non-copyable: views and pools keep pointers into the state
   GlobalState(const GlobalState &) = delete;
   GlobalState &operator=(const GlobalState &) = delete;
 
@@ -61,81 +334,130 @@ public:
   void init() {
     // Initialize game state
     level = 1;
-    score = 0;
+    simulation.setScore(0);
 
     // Set the font for text rendering
     graphics::setFont("assets/fonts/Roboto-Regular.ttf");
 
-    // Initialize stations, create initial UI elements, etc.
-
-    std::ifstream people_file("assets/metro3.json", std::ifstream::binary);
-    Json::Value metro;
-    people_file >> metro;
-
-    if (debugMode) {
-      std::cout << metro << std::endl;
-    }
-
-    // Start score thread
-    keep_thread_alive = true;
-    score_thread = std::thread([this]() {
-      while (keep_thread_alive) {
-        // Sleep in small increments to be responsive to keep_thread_alive
-        for (int i = 0; i < 100 && keep_thread_alive; ++i) {
-          std::this_thread::sleep_for(std::chrono::milliseconds(100));
-        }
-
-        if (!keep_thread_alive)
-          break;
-
-        // Only subtract score if simulation is running
-        if (simulating) {
-          score -= 2;
-          // ensure score doesn't go below 0
-          if (score < 0)
-            score = 0;
-        }
-      }
-    });
+    // Stations, trains and passengers are loaded into the simulation by
+    // the caller (see loadNetwork()), so the network is only read once
   }
 
   /**
    * @brief Update all game objects
-   * @param ms Milliseconds elapsed since last update
+   * @param frameMs Milliseconds elapsed since last update
    *
    * This method calls update() on all active VisualAsset objects,
    * allowing them to update their state (movement, animations, etc.)
+   * The simulation itself is advanced in fixed ticks by the SimClock, so
+   * the frame time only decides how many ticks run, never their size.
    */
-  void update(int ms) {
+  void update(float frameMs) {
+    int ms = static_cast<int>(frameMs);
+    auto frameStart = std::chrono::steady_clock::now();
+    ProfileScope frameScope("update");
+    frameTimes.add(frameMs);
+
     // Get mouse state once per frame
     graphics::MouseState mouse;
     graphics::getMouseState(mouse);
-
-    // Update all visual assets by category
-    for (auto *asset : stations) {
-      if (asset && asset->getIsActive()) {
-        asset->update(ms, mouse);
+    bool input = mouseChanged(mouse);
+    lastMouse = mouse;
+
+    // Time-warp control: '+' doubles, '-' halves the simulation speed
+    bool faster = graphics::getKeyState(graphics::SCANCODE_EQUALS) ||
+                  graphics::getKeyState(graphics::SCANCODE_KP_PLUS);
+    bool slower = graphics::getKeyState(graphics::SCANCODE_MINUS) ||
+                  graphics::getKeyState(graphics::SCANCODE_KP_MINUS);
+    if ((faster || slower) && !warpKeyDown) {
+      clock.setWarp(faster ? clock.getWarp() * 2.0f : clock.getWarp() / 2.0f);
+    }
+    input = input || faster || slower || warpKeyDown;
+    warpKeyDown = faster || slower;
+    if (input || simulating)
+      frameDirty = true;
+
+    // Update all visual assets by category. Stations go first so that a
+    // dragged station has moved before the simulation reads its position.
+    if (input)
+      routeMouseToStations(mouse);
+    // A hidden station changes the network layer but not the simulation
+    if (snapshot() != stationsSeen || networkLayer.isDirty()) {
+      ProfileScope scope("update.stations");
+      for (auto *asset : stations) {
+        if (asset && asset->getIsActive()) {
+          asset->update(ms, mouse);
+        }
       }
+      networkLayer.update(ms, mouse);
+      networkLayer.clearDirty();
+      stationsSeen = snapshot();
+      frameDirty = true;
     }
-    for (auto *asset : trains) {
-      if (asset && asset->getIsActive()) {
-        asset->update(ms, mouse);
+
+    if (simulating) {
+      ProfileScope scope("update.simulation");
+      int ticks = clock.advance(frameMs);
+      for (int i = 0; i < ticks && !simulation.isRunOver(); ++i) {
+        simulation.step(clock.getTickMs());
+      }
+
+      // End of run: stop simulating and report the result once
+      if (simulation.isRunOver()) {
+        simulating = false;
+        runComplete = true;
+        lastResult = simulation.getResult();
+        if (onRunComplete) {
+          onRunComplete(lastResult);
+        }
       }
     }
-    for (auto *asset : passengers) {
-      if (asset && asset->getIsActive()) {
-        asset->update(ms, mouse);
+
+    if (snapshot() != viewsSeen) {
+      ProfileScope scope("update.views");
+      simulation.syncTrainPositions();
+      for (auto *asset : trains) {
+        if (asset && asset->getIsActive()) {
+          asset->update(ms, mouse);
+        }
+      }
+      for (auto *asset : passengers) {
+        if (asset && asset->getIsActive()) {
+          asset->update(ms, mouse);
+        }
       }
+      viewsSeen = snapshot();
+      frameDirty = true;
     }
-    for (auto *asset : uiElements) {
-      if (asset && asset->getIsActive()) {
-        asset->update(ms, mouse);
+    {
+      ProfileScope scope("update.ui");
+      for (auto *asset : uiElements) {
+        if (asset && asset->getIsActive()) {
+          asset->update(ms, mouse);
+        }
       }
     }
 
-    // TODO: Update game logic (spawn passengers, move trains, etc.)
+    // New passengers are spawned inside the ticks above by the
+    // simulation's demand generator, on simulated time
+
+    if (collectDirty(stations) || collectDirty(uiElements))
+      frameDirty = true;
+    updateTimes.add(msSince(frameStart));
+    paceIdleFrame(frameMs, frameStart);
   }
 
+  /**
+   * @brief Force the next frames to run at full rate, e.g. after a change
+   * made outside update()
+   */
+  void markDirty() { frameDirty = true; }
+
+  /**
+   * @brief Whether the last frame was paced down because nothing changed
+   */
+  bool isIdle() const { return idleMs >= kIdleGraceMs; }
+
   /**
    * @brief Draw all game objects
    *
@@ -143,87 +465,113 @@ public:
    * rendering them to the screen using the SGG library.
    */
   void draw() {
-    // Draw all visual assets by category (order determines layering)
-    for (auto *asset : stations) {
-      if (asset && asset->getIsActive()) {
-        asset->draw();
+    auto drawStart = std::chrono::steady_clock::now();
+    ProfileScope frameScope("draw");
+
+    // Draw all visual assets by category (order determines layering).
+    // The network layer draws every track and station disk; station views
+    // only add the hover label on top.
+    {
+      ProfileScope scope("draw.network");
+      networkLayer.draw();
+    }
+    {
+      ProfileScope scope("draw.stations");
+      for (auto *asset : stations) {
+        if (asset && asset->getIsActive()) {
+          asset->draw();
+        }
       }
     }
-    for (auto *asset : trains) {
-      if (asset && asset->getIsActive()) {
-        asset->draw();
+    {
+      ProfileScope scope("draw.trains");
+      for (auto *asset : trains) {
+        if (asset && asset->getIsActive()) {
+          asset->draw();
+        }
       }
     }
-    for (auto *asset : passengers) {
-      if (asset && asset->getIsActive()) {
-        asset->draw();
+    {
+      ProfileScope scope("draw.passengers");
+      for (auto *asset : passengers) {
+        if (asset && asset->getIsActive()) {
+          asset->draw();
+        }
       }
     }
-    for (auto *asset : uiElements) {
-      if (asset && asset->getIsActive()) {
-        asset->draw();
+    {
+      ProfileScope scope("draw.ui");
+      for (auto *asset : uiElements) {
+        if (asset && asset->getIsActive()) {
+          asset->draw();
+        }
       }
     }
-  }
 
-  // Asset management methods
-  /**
-   * @brief Add a station
-   */
-  void addStation(VisualAsset *asset) {
-    if (asset)
-      stations.push_back(asset);
+    drawTimes.add(msSince(drawStart));
+    if (debugMode)
+      drawFrameOverlay();
   }
 
+  // Asset management methods
   /**
-   * @brief Add a train
+   * @brief Create an asset in its pool and register it for update and draw
+   * @param args Constructor arguments of T (Station, Train, PassengerLayer
+   * or SimulateButton)
+   * @return Handle to the new asset
    */
-  void addTrain(VisualAsset *asset) {
-    if (asset)
-      trains.push_back(asset);
+  template <typename T, typename... Args> Handle create(Args &&...args) {
+    Pool<T> &pool = poolFor((T *)nullptr);
+    Handle handle = pool.create(std::forward<Args>(args)...);
+    registerAsset(pool.get(handle));
+    frameDirty = true;
+    return handle;
   }
 
   /**
-   * @brief Add a passenger
+   * @brief The asset a handle refers to, or nullptr if it was destroyed
    */
-  void addPassenger(VisualAsset *asset) {
-    if (asset)
-      passengers.push_back(asset);
+  template <typename T> T *get(Handle handle) {
+    return poolFor((T *)nullptr).get(handle);
   }
 
   /**
-   * @brief Add a generic visual asset (defaults to UI elements)
-   * @param asset Pointer to the VisualAsset to add
+   * @brief Unregister an asset and release it back to its pool
+   * @return false if the handle was already stale
    */
-  void addVisualAsset(VisualAsset *asset) {
-    if (asset) {
-      uiElements.push_back(asset);
-    }
+  template <typename T> bool destroy(Handle handle) {
+    T *asset = get<T>(handle);
+    if (!asset)
+      return false;
+    removeVisualAsset(asset);
+    return poolFor((T *)nullptr).destroy(handle);
   }
 
   /**
    * @brief Remove a visual asset from management
    * @param asset Pointer to the VisualAsset to remove
-   * @note This does not delete the asset, only removes it from its container
+   * @note This does not destroy the asset, only unlists it, by moving the
+   * last asset of its category into its place
    */
   void removeVisualAsset(VisualAsset *asset) {
-    auto remove_from = [asset](std::vector<VisualAsset *> &vec) {
-      for (auto it = vec.begin(); it != vec.end(); ++it) {
-        if (*it == asset) {
-          vec.erase(it);
-          return true;
-        }
-      }
-      return false;
-    };
-
-    if (remove_from(stations))
-      return;
-    if (remove_from(trains))
+    if (!asset || asset->registryIndex < 0)
       return;
-    if (remove_from(passengers))
-      return;
-    remove_from(uiElements);
+    std::vector<VisualAsset *> &vec = listFor(asset->registryList);
+    VisualAsset *last = vec.back();
+    vec[asset->registryIndex] = last;
+    last->registryIndex = asset->registryIndex;
+    vec.pop_back();
+
+    if (asset->registryList == STATIONS) {
+      Station *station = static_cast<Station *>(asset);
+      stationGrid.remove(station->getId());
+      stationViews[station->getId()] = nullptr;
+      networkLayer.setStationVisible(station->getId(), false);
+      if (hoveredStation == station)
+        hoveredStation = nullptr;
+    }
+    asset->registryList = asset->registryIndex = -1;
+    frameDirty = true;
   }
 
   /**
@@ -238,10 +586,14 @@ public:
   int getLevel() const { return level; }
   void setLevel(int newLevel) { level = newLevel; }
 
+  // Simulation access
+  Simulation &getSimulation() { return simulation; }
+  const Simulation &getSimulation() const { return simulation; }
+
   // Score management
-  int getScore() const { return score; }
-  void setScore(int newScore) { score = newScore; }
-  void addScore(int points) { score += points; }
+  int getScore() const { return simulation.getScore(); }
+  void setScore(int newScore) { simulation.setScore(newScore); }
+  void addScore(int points) { simulation.addScore(points); }
 
   // Window size management (as mentioned in README)
   int getWindowWidth() const { return windowWidth; }
@@ -253,46 +605,41 @@ public:
 
   // Simulation state
   bool isSimulating() const { return simulating; }
-  void setSimulating(bool sim) { simulating = sim; }
+  void setSimulating(bool sim) {
+    if (sim && !simulating)
+      clock.reset();
+    simulating = sim;
+    frameDirty = true;
+  }
+
+  // Journey-completion counters, maintained incrementally by the simulation
+  int getTotalPassengers() const { return simulation.getTotalPassengers(); }
+  int getCompletedPassengers() const {
+    return simulation.getCompletedPassengers();
+  }
 
-private:
   /**
-   * @brief Private constructor for singleton pattern
+   * @brief Register the end-of-run hook
+   * @param callback Called once with the result when all passengers arrive
    */
-  GlobalState()
-      : level(0), score(0), windowWidth(800), windowHeight(600),
-        simulating(false), keep_thread_alive(true), debugMode(false) {}
+  void setOnRunComplete(std::function<void(const RunResult &)> callback) {
+    onRunComplete = callback;
+  }
+  bool isRunComplete() const { return runComplete; }
+  const RunResult &getLastResult() const { return lastResult; }
+
+  // Time-warp (1x - 1000x)
+  float getTimeWarp() const { return clock.getWarp(); }
+  void setTimeWarp(float warp) { clock.setWarp(warp); }
 
-public:
   bool isDebugMode() const { return debugMode; }
-  void setDebugMode(bool debug) { debugMode = debug; }
+  void setDebugMode(bool debug) {
+    debugMode = debug;
+    simulation.setDebugMode(debug);
+  }
 
 private:
   bool debugMode;
-
-  /**
-   * @brief Private destructor - cleans up all visual assets
-   */
-  ~GlobalState() {
-    // Stop thread
-    keep_thread_alive = false;
-    if (score_thread.joinable()) {
-      score_thread.join();
-    }
-
-    // Clean up all visual assets
-    auto cleanup = [](std::vector<VisualAsset *> &vec) {
-      for (auto *asset : vec) {
-        delete asset;
-      }
-      vec.clear();
-    };
-
-    cleanup(stations);
-    cleanup(trains);
-    cleanup(passengers);
-    cleanup(uiElements);
-  }
 };
 
 #endif // GLOBAL_STATE_H
\ No newline at end of file
@@ -0,0 +1,26 @@
+#ifndef HANDLE_H
+#define HANDLE_H
+
+#include <cstdint>
+
+/**
+ * @brief Generational reference to a pooled object.
+ *
+ * A slot's generation is bumped every time the object in it is released,
+ * so a handle kept past the object's lifetime no longer matches and is
+ * detected as stale instead of silently aliasing whatever reuses the slot.
+ */
+struct Handle {
+  static constexpr uint32_t kInvalidIndex = 0xFFFFFFFFu;
+
+  uint32_t index = kInvalidIndex;
+  uint32_t generation = 0;
+
+  bool isNull() const { return index == kInvalidIndex; }
+  bool operator==(const Handle &o) const {
+    return index == o.index && generation == o.generation;
+  }
+  bool operator!=(const Handle &o) const { return !(*this == o); }
+};
+
+#endif // HANDLE_H
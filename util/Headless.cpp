@@ -0,0 +1,197 @@
+#include "Headless.h"
+#include "CommandLine.h"
+#include "Dispatch.h"
+#include "NetworkLoader.h"
+#include "Profiler.h"
+#include "Scenario.h"
+#include "Simulation.h"
+#include <chrono>
+#include <cstdlib>
+#include <iomanip>
+#include <iostream>
+#include <memory>
+#include <stdexcept>
+#include <string>
+#include <vector>
+
+/**
+ * @brief Load the network and spawn the starting trains and riders for one
+ * run
+ * @return false if the network could not be loaded
+ */
+static bool setupRun(Simulation &sim, const std::string &networkPath,
+                     const std::string &policy, int trains, int riders,
+                     const DemandOptions &demand) {
+  sim.setDispatchPolicy(makeDispatchPolicy(policy));
+  try {
+    loadNetwork(sim, networkPath, 800, 600);
+  } catch (const std::runtime_error &e) {
+    std::cerr << "File error: " << e.what() << std::endl;
+    return false;
+  }
+  setupScenario(sim, trains, riders);
+  try {
+    setupDemand(sim, demand);
+  } catch (const std::runtime_error &e) {
+    std::cerr << "Demand error: " << e.what() << std::endl;
+    return false;
+  }
+  return true;
+}
+
+/**
+ * @brief Warn about waiting riders the dispatch policy will never carry
+ */
+static void warnStranded(const Simulation &sim) {
+  int stranded = sim.getDispatchPolicy().countStranded(sim);
+  if (stranded > 0)
+    std::cerr << "Warning: " << stranded << " waiting riders need a "
+              << "connection no " << sim.getDispatchPolicy().getName()
+              << " train runs along; they will never arrive" << std::endl;
+}
+
+int runHeadless(int argc, char *argv[]) {
+  std::string networkPath =
+      getArgValue(argc, argv, "--network", "assets/metro3.json");
+  long long maxSimMs =
+      std::atoll(getArgValue(argc, argv, "--max-minutes", "1440").c_str()) *
+      60 * 1000;
+  std::string policy = getArgValue(argc, argv, "--dispatch", "demand");
+  int trains = std::atoi(getArgValue(argc, argv, "--trains", "3").c_str());
+  int riders = std::atoi(getArgValue(argc, argv, "--riders", "20").c_str());
+  bool debug = hasArg(argc, argv, "-DEBUG");
+  int threads = std::atoi(getArgValue(argc, argv, "--threads", "1").c_str());
+  std::string engine = getArgValue(argc, argv, "--engine", "tick");
+  if (engine != "tick" && engine != "event") {
+    std::cerr << "Unknown engine '" << engine << "'" << std::endl;
+    return 1;
+  }
+  float lineSpeed = (float)std::atof(
+      getArgValue(argc, argv, "--line-speed",
+                  std::to_string(Simulation::kDefaultLineSpeed))
+          .c_str());
+  // No continuous demand unless asked for, so a seed keeps replaying the
+  // same 20-rider demo
+  DemandOptions demand = getDemandArgs(argc, argv, 0.0);
+  uint64_t seed = getSeedArg(argc, argv);
+  std::cout << "Seed: " << seed << std::endl;
+  std::string tracePath = getArgValue(argc, argv, "--trace");
+  std::string journalPath = getArgValue(argc, argv, "--journal");
+  if (!tracePath.empty()) {
+    Profiler::setThreadName("main");
+    Profiler::setEnabled(true);
+  }
+
+  std::vector<std::string> policies;
+  if (policy == "all") {
+    policies = dispatchPolicyNames();
+  } else if (makeDispatchPolicy(policy)) {
+    policies.push_back(policy);
+  } else {
+    std::cerr << "Unknown dispatch policy '" << policy << "'" << std::endl;
+    return 1;
+  }
+
+  // Every policy runs the same seed, so they face the same network and riders
+  for (const std::string &name : policies) {
+    Simulation sim;
+    sim.setDebugMode(debug);
+    sim.setSeed(seed);
+    sim.setThreadCount(threads);
+    sim.setLineSpeed(lineSpeed);
+    sim.setEngine(engine == "event" ? Simulation::EVENT_DRIVEN
+                                    : Simulation::TICKED);
+    if (!journalPath.empty()) {
+      // One journal per policy when comparing them
+      std::string path = journalPath;
+      if (policies.size() > 1)
+        path += "." + name;
+      std::unique_ptr<Journal> journal(new Journal());
+      try {
+        journal->open(path);
+      } catch (const std::runtime_error &e) {
+        std::cerr << "Journal error: " << e.what() << std::endl;
+        return 1;
+      }
+      std::cout << "Journal: " << path << std::endl;
+      sim.setJournal(std::move(journal));
+    }
+    if (!setupRun(sim, networkPath, name, trains, riders, demand))
+      return 1;
+
+    std::cout << "Headless run (" << name << " dispatch): "
+              << sim.getStations().size() << " stations, "
+              << sim.getTrains().size() << " trains, "
+              << sim.getTotalPassengers() << " passengers, "
+              << sim.getThreadCount() << " thread(s)" << std::endl;
+    if (sim.getDemand()) {
+      std::cout << "Demand: " << demand.ridersPerHour
+                << " riders/hour per station";
+      if (!demand.flowsPath.empty())
+        std::cout << " plus flows from " << demand.flowsPath;
+      std::cout << ", " << demand.profile << " profile from "
+                << demand.startHour << ":00" << std::endl;
+    }
+
+    warnStranded(sim);
+
+    auto wallStart = std::chrono::steady_clock::now();
+    RunResult result = sim.runUntilDone(maxSimMs);
+    double wallSec = std::chrono::duration<double>(
+                         std::chrono::steady_clock::now() - wallStart)
+                         .count();
+
+    double simSec = result.simMs / 1000.0;
+    std::cout << (result.allArrived ? "All passengers have arrived."
+                                    : "Simulated time limit reached.")
+              << std::endl;
+    if (const DemandGenerator *generator = sim.getDemand()) {
+      std::cout << "Demand spawned " << generator->getSpawned() << " riders";
+      if (generator->getUnroutable() > 0)
+        std::cout << " (" << generator->getUnroutable()
+                  << " dropped with no route)";
+      std::cout << std::endl;
+    }
+    if (!result.allArrived)
+      warnStranded(sim);
+    std::cout << "Delivered " << result.completed << "/" << result.passengers
+              << " passengers (" << std::fixed << std::setprecision(2)
+              << result.throughputPerMinute << " per simulated minute)"
+              << std::defaultfloat << std::setprecision(6) << std::endl;
+    std::cout << "Simulated time: " << simSec << " s in " << result.steps
+              << " steps (" << wallSec << " s wall, "
+              << (wallSec > 0.0 ? simSec / wallSec : 0.0) << "x real time)"
+              << std::endl;
+    std::cout << "Final score: " << result.score << " (";
+    const ScoreKeeper &scoring = sim.getScoring();
+    for (size_t i = 0; i < scoring.getRules().size(); ++i) {
+      std::cout << (i ? ", " : "") << scoring.getRules()[i].name << " "
+                << std::showpos << scoring.getTotal(i) << std::noshowpos;
+    }
+    std::cout << ")" << std::endl;
+
+    if (Journal *journal = sim.getJournal()) {
+      uint64_t events = journal->getRecorded();
+      if (!journal->close()) {
+        std::cerr << "Journal error: could not write every event"
+                  << std::endl;
+        return 1;
+      }
+      std::cout << "Journaled " << events << " events";
+      if (journal->getStalls() > 0)
+        std::cout << " (" << journal->getStalls()
+                  << " waits for the writer)";
+      std::cout << std::endl;
+    }
+  }
+
+  if (!tracePath.empty()) {
+    Profiler::setEnabled(false);
+    if (!Profiler::writeChromeTrace(tracePath)) {
+      std::cerr << "Could not write trace to " << tracePath << std::endl;
+      return 1;
+    }
+    std::cout << "Trace written to " << tracePath << std::endl;
+  }
+  return 0;
+}
@@ -0,0 +1,41 @@
+#ifndef HEADLESS_H
+#define HEADLESS_H
+
+/**
+ * @brief Run the simulation without a window
+ * @param argc Argument count as passed to main()
+ * @param argv Arguments as passed to main()
+ * @return Process exit code
+ *
+ * Loads the network, spawns the starting trains and riders and steps the simulation at
+ * Simulation::kFixedStepMs as fast as the CPU allows until the run is over
+ * (see Simulation::isRunOver()) or the simulated time limit is reached.
+ *
+ * Recognised arguments:
+ *   --network=<path>      network JSON (default assets/metro3.json)
+ *   --max-minutes=<n>     simulated time limit (default 24 hours)
+ *   --seed=<n>            run seed; the same seed reproduces a run exactly
+ *   --trains=<n>          trains at the start (default 3)
+ *   --riders=<n>          riders spawned at the start (default 20); with
+ *                         --trains, replays a run of athens-metro-batch
+ *   --dispatch=<policy>   random, demand (default), shuttle, or all to run
+ *                         every policy on the same seed and compare them
+ *   --threads=<n>         threads per tick (default 1)
+ *   --engine=<e>          tick (default) moves every train every tick;
+ *                         event jumps from one arrival to the next and
+ *                         gives the same run much faster
+ *   --line-speed=<v>      train speed in pixels per simulated second
+ *                         (default Simulation::kDefaultLineSpeed)
+ *   --demand=<r>          continuous demand, riders per hour per station
+ *                         (default 0: only the demo riders); see
+ *                         getDemandArgs() for the other --demand-* options
+ *   --journal=<path>      record every spawn, boarding, alighting, arrival
+ *                         and score change to a binary journal (see
+ *                         athens-metro-journal to convert it to CSV)
+ *   --trace=<path>        record a per-phase profile of the run and write
+ *                         it as Chrome trace-event JSON
+ *   -DEBUG                verbose logging
+ */
+int runHeadless(int argc, char *argv[]);
+
+#endif // HEADLESS_H
@@ -0,0 +1,101 @@
+#ifndef HISTOGRAM_H
+#define HISTOGRAM_H
+
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+
+/**
+ * @brief Log-linear histogram of non-negative integer samples, such as
+ * wait times in milliseconds.
+ *
+ * Values below 128 get a bucket each; above that every power of two is
+ * split into 64 buckets, so a percentile is within 1.6% of the true value
+ * while the whole 32-bit range fits in kBuckets counters. Histograms of the
+ * same kind add up with merge(), in any order.
+ */
+class Histogram {
+public:
+  static constexpr int kSubBuckets = 64;
+  static constexpr int kBuckets = 2 * kSubBuckets + 25 * kSubBuckets;
+
+  Histogram() : counts(kBuckets, 0), count(0), sum(0), max(0) {}
+
+  void add(uint32_t value) {
+    counts[bucketOf(value)]++;
+    count++;
+    sum += value;
+    if (value > max)
+      max = value;
+  }
+
+  void merge(const Histogram &other) {
+    for (int i = 0; i < kBuckets; ++i)
+      counts[i] += other.counts[i];
+    count += other.count;
+    sum += other.sum;
+    if (other.max > max)
+      max = other.max;
+  }
+
+  void clear() {
+    counts.assign(kBuckets, 0);
+    count = sum = 0;
+    max = 0;
+  }
+
+  uint64_t getCount() const { return count; }
+  uint32_t getMax() const { return max; }
+  double getMean() const { return count ? (double)sum / (double)count : 0.0; }
+
+  /**
+   * @brief The p-th percentile (0..100): the lowest value of the bucket
+   * holding it, or 0 if the histogram is empty
+   */
+  uint32_t percentile(double p) const {
+    if (count == 0)
+      return 0;
+    uint64_t rank = (uint64_t)(p / 100.0 * (double)(count - 1));
+    uint64_t seen = 0;
+    for (int i = 0; i < kBuckets; ++i) {
+      seen += counts[i];
+      if (seen > rank)
+        return lowestIn(i);
+    }
+    return max;
+  }
+
+private:
+  std::vector<uint64_t> counts;
+  uint64_t count;
+  uint64_t sum;
+  uint32_t max;
+
+  static int bitLength(uint32_t v) {
+    int n = 0;
+    while (v) {
+      v >>= 1;
+      n++;
+    }
+    return n;
+  }
+
+  static int bucketOf(uint32_t value) {
+    if (value < 2 * kSubBuckets)
+      return (int)value;
+    int shift = bitLength(value) - 7; // leaves value >> shift in [64, 128)
+    return 2 * kSubBuckets + (shift - 1) * kSubBuckets +
+           (int)(value >> shift) - kSubBuckets;
+  }
+
+  static uint32_t lowestIn(int bucket) {
+    if (bucket < 2 * kSubBuckets)
+      return (uint32_t)bucket;
+    int shift = (bucket - 2 * kSubBuckets) / kSubBuckets + 1;
+    uint32_t top = (uint32_t)((bucket - 2 * kSubBuckets) % kSubBuckets +
+                              kSubBuckets);
+    return top << shift;
+  }
+};
+
+#endif // HISTOGRAM_H
@@ -0,0 +1,132 @@
+#include "Journal.h"
+#include <chrono>
+#include <cstring>
+#include <stdexcept>
+#include <vector>
+
+namespace {
+
+const char kMagic[8] = {'A', 'M', 'J', 'O', 'U', 'R', 'N', 'L'};
+
+struct JournalHeader {
+  char magic[8];
+  uint32_t version;
+  uint32_t recordSize;
+};
+
+// Events the writer moves from the queue per fwrite()
+const size_t kWriteBatch = 4096;
+
+} // namespace
+
+const char *journalEventName(uint8_t type) {
+  switch (type) {
+  case JournalEvent::SPAWN:
+    return "spawn";
+  case JournalEvent::BOARD:
+    return "board";
+  case JournalEvent::ALIGHT:
+    return "alight";
+  case JournalEvent::ARRIVE:
+    return "arrive";
+  case JournalEvent::SCORE:
+    return "score";
+  default:
+    return "unknown";
+  }
+}
+
+Journal::Journal()
+    : queue(kQueueEvents), stopping(false), file(nullptr), failed(false),
+      recorded(0), stalls(0) {}
+
+Journal::~Journal() { close(); }
+
+void Journal::open(const std::string &path) {
+  close();
+  file = std::fopen(path.c_str(), "wb");
+  if (!file)
+    throw std::runtime_error("Could not create journal " + path);
+  std::setvbuf(file, nullptr, _IOFBF, 1 << 20);
+
+  JournalHeader header;
+  std::memcpy(header.magic, kMagic, sizeof(kMagic));
+  header.version = kVersion;
+  header.recordSize = sizeof(JournalEvent);
+  failed = std::fwrite(&header, sizeof(header), 1, file) != 1;
+
+  recorded = 0;
+  stalls = 0;
+  stopping = false;
+  writer = std::thread(&Journal::writeLoop, this);
+}
+
+bool Journal::close() {
+  if (!writer.joinable())
+    return !failed;
+  stopping = true;
+  writer.join();
+  if (std::fclose(file) != 0)
+    failed = true;
+  file = nullptr;
+  return !failed;
+}
+
+void Journal::waitAndPush(const JournalEvent &event) {
+  stalls++;
+  while (!queue.push(event))
+    std::this_thread::yield();
+}
+
+void Journal::writeLoop() {
+  std::vector<JournalEvent> batch(kWriteBatch);
+  for (;;) {
+    // Read the flag first: if it was set, everything recorded before it is
+    // already in the queue, so an empty queue means we are done
+    bool last = stopping.load(std::memory_order_acquire);
+    size_t n;
+    while ((n = queue.pop(batch.data(), batch.size())) > 0) {
+      if (std::fwrite(batch.data(), sizeof(JournalEvent), n, file) != n)
+        failed = true;
+    }
+    if (last)
+      return;
+    std::this_thread::sleep_for(std::chrono::milliseconds(1));
+  }
+}
+
+uint64_t readJournal(const std::string &path,
+                     const std::function<void(const JournalEvent &)> &visit) {
+  std::FILE *file = std::fopen(path.c_str(), "rb");
+  if (!file)
+    throw std::runtime_error("Could not open journal " + path);
+
+  JournalHeader header;
+  if (std::fread(&header, sizeof(header), 1, file) != 1 ||
+      std::memcmp(header.magic, kMagic, sizeof(kMagic)) != 0) {
+    std::fclose(file);
+    throw std::runtime_error(path + " is not a journal");
+  }
+  // The version first: older versions had other record sizes
+  if (header.version != Journal::kVersion) {
+    std::fclose(file);
+    throw std::runtime_error(path + " has unsupported journal version " +
+                             std::to_string(header.version));
+  }
+  if (header.recordSize != sizeof(JournalEvent)) {
+    std::fclose(file);
+    throw std::runtime_error(path + " is not a journal");
+  }
+
+  std::vector<JournalEvent> batch(kWriteBatch);
+  uint64_t count = 0;
+  size_t n;
+  while ((n = std::fread(batch.data(), sizeof(JournalEvent), batch.size(),
+                         file)) > 0) {
+    for (size_t i = 0; i < n; ++i)
+      visit(batch[i]);
+    count += n;
+  }
+  std::fclose(file);
+  return count;
+}
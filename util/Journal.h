@@ -0,0 +1,119 @@
+#ifndef JOURNAL_H
+#define JOURNAL_H
+
+#include "SpscQueue.h"
+#include <atomic>
+#include <cstdint>
+#include <cstdio>
+#include <functional>
+#include <string>
+#include <thread>
+
+/**
+ * @brief One journal record, 32 bytes on disk.
+ *
+ * Fields that do not apply to an event type are -1:
+ *  - SPAWN: passenger appears at station, heading for value (a station)
+ *  - BOARD: passenger boards train at station
+ *  - ALIGHT: passenger leaves train at station to change trains
+ *  - ARRIVE: passenger leaves train at station, their destination
+ *  - SCORE: the score became value
+ *
+ * Passenger ids are reused once a rider arrives, so an id names the rider
+ * from its SPAWN up to its ARRIVE.
+ */
+struct JournalEvent {
+  enum Type : uint8_t { SPAWN, BOARD, ALIGHT, ARRIVE, SCORE };
+
+  uint64_t timeMs; // simulated time, end of the tick the event happened in
+  uint8_t type;
+  uint8_t reserved[7];
+  int32_t passenger;
+  int32_t train;
+  int32_t station;
+  int32_t value;
+};
+
+static_assert(sizeof(JournalEvent) == 32, "journal records are 32 bytes");
+
+/**
+ * @brief Name of an event type as written by the CSV converter
+ */
+const char *journalEventName(uint8_t type);
+
+/**
+ * @brief Appends simulation events to a binary file from a background
+ * thread.
+ *
+ * record() only copies the event into a lock-free SPSC queue; a writer
+ * thread drains the queue into a buffered file. The simulation thread
+ * therefore never formats text or waits on the disk, unless it outruns the
+ * writer and fills the queue, in which case it waits for room (counted in
+ * getStalls()) so no event is lost.
+ *
+ * The file is a 16-byte header ("AMJOURNL", format version, record size)
+ * followed by JournalEvent records in native byte order.
+ */
+class Journal {
+public:
+  /// 2: 64-bit timestamps (version 1 wrapped after 49.7 simulated days)
+  static constexpr uint32_t kVersion = 2;
+  static constexpr size_t kQueueEvents = 1 << 16;
+
+  Journal();
+  ~Journal();
+
+  Journal(const Journal &) = delete;
+  Journal &operator=(const Journal &) = delete;
+
+  /**
+   * @brief Create (or truncate) the file and start the writer thread
+   * @throws std::runtime_error if the file cannot be created
+   */
+  void open(const std::string &path);
+
+  /**
+   * @brief Write out every queued event, stop the writer and close the file
+   * @return false if any write failed
+   */
+  bool close();
+
+  bool isOpen() const { return writer.joinable(); }
+
+  /**
+   * @brief Queue an event. Only one thread may record at a time.
+   */
+  void record(const JournalEvent &event) {
+    if (!queue.push(event))
+      waitAndPush(event);
+    recorded++;
+  }
+
+  /// Events recorded since open()
+  uint64_t getRecorded() const { return recorded; }
+  /// Times record() found the queue full and had to wait for the writer
+  uint64_t getStalls() const { return stalls; }
+
+private:
+  void waitAndPush(const JournalEvent &event);
+  void writeLoop();
+
+  SpscQueue<JournalEvent> queue;
+  std::thread writer;
+  std::atomic<bool> stopping;
+  std::FILE *file;
+  bool failed; // set by the writer thread, read after it is joined
+  uint64_t recorded;
+  uint64_t stalls;
+};
+
+/**
+ * @brief Read a journal file, calling visit on every event in order
+ * @return Number of events read
+ * @throws std::runtime_error if the file is missing, not a journal, or of
+ * an unknown version
+ */
+uint64_t readJournal(const std::string &path,
+                     const std::function<void(const JournalEvent &)> &visit);
+
+#endif // JOURNAL_H
@@ -0,0 +1,353 @@
+#include "JsonReader.h"
+#include <cstdio>
+#include <cstdlib>
+
+static const size_t kChunkBytes = 64 * 1024;
+
+JsonReader::JsonReader(std::istream &input)
+    : in(input), buffer(kChunkBytes), pos(0), end(0), eof(false), line(1),
+      column(1), tokenLine(1), tokenColumn(1), finished(false),
+      numberValue(0.0), boolValue(false) {}
+
+bool JsonReader::fill() {
+  if (eof)
+    return false;
+  in.read(buffer.data(), (std::streamsize)buffer.size());
+  end = (size_t)in.gcount();
+  pos = 0;
+  if (end == 0)
+    eof = true;
+  return end > 0;
+}
+
+int JsonReader::peek() {
+  if (pos == end && !fill())
+    return EOF;
+  return (unsigned char)buffer[pos];
+}
+
+int JsonReader::get() {
+  int c = peek();
+  if (c == EOF)
+    return EOF;
+  pos++;
+  if (c == '\n') {
+    line++;
+    column = 1;
+  } else {
+    column++;
+  }
+  return c;
+}
+
+void JsonReader::fail(const std::string &message) const {
+  throw JsonParseError(message, tokenLine, tokenColumn);
+}
+
+void JsonReader::failHere(const std::string &message) const {
+  throw JsonParseError(message, line, column);
+}
+
+void JsonReader::skipSpace() {
+  for (;;) {
+    int c = peek();
+    if (c == ' ' || c == '\t' || c == '\n' || c == '\r') {
+      get();
+    } else if (c == '/') {
+      get();
+      int kind = get();
+      if (kind == '/') {
+        while (peek() != EOF && peek() != '\n')
+          get();
+      } else if (kind == '*') {
+        int prev = 0;
+        for (;;) {
+          int d = get();
+          if (d == EOF)
+            failHere("unterminated comment");
+          if (prev == '*' && d == '/')
+            break;
+          prev = d;
+        }
+      } else {
+        failHere("unexpected character '/'");
+      }
+    } else {
+      return;
+    }
+  }
+}
+
+JsonReader::Token JsonReader::next() {
+  for (;;) {
+    skipSpace();
+    tokenLine = line;
+    tokenColumn = column;
+    int c = peek();
+
+    if (stack.empty()) {
+      if (!finished)
+        return beginValue();
+      if (c != EOF)
+        fail("unexpected data after the end of the document");
+      return END;
+    }
+
+    Frame &frame = stack.back();
+    if (frame.object) {
+      switch (frame.state) {
+      case FIRST:
+        if (c == '}') {
+          get();
+          stack.pop_back();
+          finished = stack.empty();
+          return END_OBJECT;
+        }
+        // fall through
+      case KEY_NEXT:
+        if (c != '"')
+          fail(c == EOF ? "unexpected end of file" : "expected a string key");
+        readString();
+        skipSpace();
+        if (get() != ':')
+          failHere("expected ':' after object key");
+        frame.state = VALUE_NEXT;
+        return KEY;
+      case VALUE_NEXT:
+        frame.state = AFTER_VALUE;
+        return beginValue();
+      case AFTER_VALUE:
+        if (c == ',') {
+          get();
+          frame.state = KEY_NEXT;
+          continue;
+        }
+        if (c == '}') {
+          get();
+          stack.pop_back();
+          finished = stack.empty();
+          return END_OBJECT;
+        }
+        fail(c == EOF ? "unexpected end of file" : "expected ',' or '}'");
+      }
+    } else {
+      switch (frame.state) {
+      case FIRST:
+        if (c == ']') {
+          get();
+          stack.pop_back();
+          finished = stack.empty();
+          return END_ARRAY;
+        }
+        // fall through
+      case KEY_NEXT:
+      case VALUE_NEXT:
+        frame.state = AFTER_VALUE;
+        return beginValue();
+      case AFTER_VALUE:
+        if (c == ',') {
+          get();
+          frame.state = VALUE_NEXT;
+          continue;
+        }
+        if (c == ']') {
+          get();
+          stack.pop_back();
+          finished = stack.empty();
+          return END_ARRAY;
+        }
+        fail(c == EOF ? "unexpected end of file" : "expected ',' or ']'");
+      }
+    }
+  }
+}
+
+JsonReader::Token JsonReader::beginValue() {
+  int c = peek();
+  Token token;
+  switch (c) {
+  case '{':
+  case '[':
+    if (stack.size() >= kMaxDepth)
+      fail("nesting too deep");
+    get();
+    stack.push_back(Frame{c == '{', FIRST});
+    return c == '{' ? BEGIN_OBJECT : BEGIN_ARRAY;
+  case '"':
+    readString();
+    token = STRING;
+    break;
+  case 't':
+    readLiteral("true");
+    boolValue = true;
+    token = BOOLEAN;
+    break;
+  case 'f':
+    readLiteral("false");
+    boolValue = false;
+    token = BOOLEAN;
+    break;
+  case 'n':
+    readLiteral("null");
+    token = NULL_VALUE;
+    break;
+  case EOF:
+    fail("unexpected end of file");
+  default:
+    if (c == '-' || (c >= '0' && c <= '9')) {
+      readNumber();
+      token = NUMBER;
+      break;
+    }
+    fail(std::string("unexpected character '") + (char)c + "'");
+  }
+  finished = stack.empty();
+  return token;
+}
+
+void JsonReader::readLiteral(const char *word) {
+  for (const char *p = word; *p; ++p) {
+    if (get() != *p)
+      fail(std::string("invalid literal, expected '") + word + "'");
+  }
+}
+
+void JsonReader::readNumber() {
+  value.clear();
+  auto digits = [this]() {
+    int count = 0;
+    while (peek() >= '0' && peek() <= '9') {
+      value.push_back((char)get());
+      count++;
+    }
+    return count;
+  };
+
+  if (peek() == '-')
+    value.push_back((char)get());
+  if (digits() == 0)
+    failHere("expected a digit");
+  if (peek() == '.') {
+    value.push_back((char)get());
+    if (digits() == 0)
+      failHere("expected a digit after '.'");
+  }
+  if (peek() == 'e' || peek() == 'E') {
+    value.push_back((char)get());
+    if (peek() == '+' || peek() == '-')
+      value.push_back((char)get());
+    if (digits() == 0)
+      failHere("expected a digit in the exponent");
+  }
+  numberValue = std::strtod(value.c_str(), nullptr);
+}
+
+unsigned JsonReader::readHex4() {
+  unsigned code = 0;
+  for (int i = 0; i < 4; ++i) {
+    int c = get();
+    code <<= 4;
+    if (c >= '0' && c <= '9')
+      code |= c - '0';
+    else if (c >= 'a' && c <= 'f')
+      code |= c - 'a' + 10;
+    else if (c >= 'A' && c <= 'F')
+      code |= c - 'A' + 10;
+    else
+      failHere("invalid \\u escape");
+  }
+  return code;
+}
+
+void JsonReader::appendUtf8(unsigned cp) {
+  if (cp < 0x80) {
+    value.push_back((char)cp);
+  } else if (cp < 0x800) {
+    value.push_back((char)(0xC0 | (cp >> 6)));
+    value.push_back((char)(0x80 | (cp & 0x3F)));
+  } else if (cp < 0x10000) {
+    value.push_back((char)(0xE0 | (cp >> 12)));
+    value.push_back((char)(0x80 | ((cp >> 6) & 0x3F)));
+    value.push_back((char)(0x80 | (cp & 0x3F)));
+  } else {
+    value.push_back((char)(0xF0 | (cp >> 18)));
+    value.push_back((char)(0x80 | ((cp >> 12) & 0x3F)));
+    value.push_back((char)(0x80 | ((cp >> 6) & 0x3F)));
+    value.push_back((char)(0x80 | (cp & 0x3F)));
+  }
+}
+
+void JsonReader::readString() {
+  value.clear();
+  get(); // opening quote
+  for (;;) {
+    int c = get();
+    if (c == EOF)
+      fail("unterminated string");
+    if (c == '"')
+      return;
+    if (c < 0x20)
+      failHere("control character in string");
+    if (c != '\\') {
+      value.push_back((char)c);
+      continue;
+    }
+
+    int e = get();
+    switch (e) {
+    case '"':
+    case '\\':
+    case '/':
+      value.push_back((char)e);
+      break;
+    case 'b':
+      value.push_back('\b');
+      break;
+    case 'f':
+      value.push_back('\f');
+      break;
+    case 'n':
+      value.push_back('\n');
+      break;
+    case 'r':
+      value.push_back('\r');
+      break;
+    case 't':
+      value.push_back('\t');
+      break;
+    case 'u': {
+      unsigned cp = readHex4();
+      if (cp >= 0xD800 && cp < 0xDC00) {
+        // High surrogate: must be followed by the low half
+        if (get() != '\\' || get() != 'u')
+          failHere("unpaired surrogate in \\u escape");
+        unsigned low = readHex4();
+        if (low < 0xDC00 || low >= 0xE000)
+          failHere("unpaired surrogate in \\u escape");
+        cp = 0x10000 + ((cp - 0xD800) << 10) + (low - 0xDC00);
+      }
+      appendUtf8(cp);
+      break;
+    }
+    default:
+      failHere("invalid escape in string");
+    }
+  }
+}
+
+void JsonReader::skipValue() {
+  Token token = next();
+  if (token == BEGIN_OBJECT || token == BEGIN_ARRAY)
+    skipContainer();
+}
+
+void JsonReader::skipContainer() {
+  int depth = 1;
+  while (depth > 0) {
+    Token token = next();
+    if (token == BEGIN_OBJECT || token == BEGIN_ARRAY)
+      depth++;
+    else if (token == END_OBJECT || token == END_ARRAY)
+      depth--;
+  }
+}
@@ -0,0 +1,127 @@
+#ifndef JSON_READER_H
+#define JSON_READER_H
+
+#include <istream>
+#include <stdexcept>
+#include <string>
+#include <vector>
+
+/**
+ * @brief Syntax error in a JSON document, with the position it was found at
+ */
+class JsonParseError : public std::runtime_error {
+public:
+  JsonParseError(const std::string &message, int line, int column)
+      : std::runtime_error("line " + std::to_string(line) + ", column " +
+                           std::to_string(column) + ": " + message),
+        line(line), column(column) {}
+
+  int getLine() const { return line; }
+  int getColumn() const { return column; }
+
+private:
+  int line;
+  int column;
+};
+
+/**
+ * @brief Streaming (pull) JSON parser.
+ *
+ * Reads the document from a stream in fixed-size chunks and hands it out
+ * one token at a time, so memory use is bounded by the largest single
+ * string and the nesting depth, never by the size of the document. The
+ * grammar is checked as tokens are pulled; any error throws a
+ * JsonParseError carrying the line and column. Like jsoncpp's default
+ * reader, // and C-style comments are allowed between tokens.
+ */
+class JsonReader {
+public:
+  enum Token {
+    BEGIN_OBJECT,
+    END_OBJECT,
+    BEGIN_ARRAY,
+    END_ARRAY,
+    KEY,    // an object key; text() holds it
+    STRING, // text() holds the decoded string
+    NUMBER, // number() holds the value
+    BOOLEAN,
+    NULL_VALUE,
+    END // the document is complete
+  };
+
+  /// Containers nested deeper than this are rejected
+  static constexpr size_t kMaxDepth = 256;
+
+  explicit JsonReader(std::istream &in);
+
+  /**
+   * @brief Read the next token
+   * @throws JsonParseError on a syntax error
+   */
+  Token next();
+
+  /**
+   * @brief Skip the value that comes next, including everything inside it
+   * if it is an object or array. Call after a KEY, or where an array
+   * element is expected.
+   */
+  void skipValue();
+
+  /**
+   * @brief Skip the rest of a container whose BEGIN token was just read
+   */
+  void skipContainer();
+
+  const std::string &text() const { return value; }
+  double number() const { return numberValue; }
+  bool boolean() const { return boolValue; }
+
+  /// Position of the first character of the last token
+  int getLine() const { return tokenLine; }
+  int getColumn() const { return tokenColumn; }
+
+  /**
+   * @brief Throw a JsonParseError at the position of the last token
+   */
+  [[noreturn]] void fail(const std::string &message) const;
+
+private:
+  enum State { FIRST, KEY_NEXT, VALUE_NEXT, AFTER_VALUE };
+  struct Frame {
+    bool object;
+    State state;
+  };
+
+  std::istream &in;
+  std::vector<char> buffer;
+  size_t pos;
+  size_t end;
+  bool eof;
+
+  int line;
+  int column;
+  int tokenLine;
+  int tokenColumn;
+
+  std::vector<Frame> stack;
+  bool finished;
+
+  std::string value;
+  double numberValue;
+  bool boolValue;
+
+  int peek();
+  int get();
+  bool fill();
+  void skipSpace();
+  [[noreturn]] void failHere(const std::string &message) const;
+
+  Token beginValue();
+  void readString();
+  void readNumber();
+  void readLiteral(const char *word);
+  void appendUtf8(unsigned codepoint);
+  unsigned readHex4();
+};
+
+#endif // JSON_READER_H
@@ -0,0 +1,240 @@
+#include "NetworkGen.h"
+#include "Rng.h"
+#include <algorithm>
+#include <cmath>
+#include <cstdio>
+#include <cstring>
+#include <stdexcept>
+#include <utility>
+
+namespace {
+
+typedef std::vector<std::pair<uint32_t, uint32_t>> TrackList;
+
+const float kPi = 3.14159265f;
+
+void layoutGrid(GeneratedNetwork &net, const NetworkGenOptions &options,
+                TrackList &tracks) {
+  int n = net.stationCount;
+  int cols = (int)std::ceil(std::sqrt((double)n));
+  int rows = (n + cols - 1) / cols;
+  float dx = options.width / (float)(cols + 1);
+  float dy = options.height / (float)(rows + 1);
+
+  for (int i = 0; i < n; ++i) {
+    int c = i % cols;
+    int r = i / cols;
+    net.x[i] = (float)(c + 1) * dx;
+    net.y[i] = (float)(r + 1) * dy;
+    if (c + 1 < cols && i + 1 < n)
+      tracks.push_back(std::make_pair(i, i + 1));
+    if (i + cols < n)
+      tracks.push_back(std::make_pair(i, i + cols));
+  }
+}
+
+void layoutRadial(GeneratedNetwork &net, const NetworkGenOptions &options,
+                  Rng &rng, TrackList &tracks) {
+  int n = net.stationCount;
+  int lines = std::max(1, std::min(options.lines, kMaxGeneratedConnections));
+  int ringEvery = std::max(1, options.ringEvery);
+  int maxDepth = (n - 2) / lines + 1;
+  float cx = options.width / 2.0f;
+  float cy = options.height / 2.0f;
+  float step = std::min(cx, cy) / (float)(maxDepth + 1);
+
+  // Station 0 is the hub; the rest go round the spokes one stop at a time
+  net.x[0] = cx;
+  net.y[0] = cy;
+  for (int i = 1; i < n; ++i) {
+    int line = (i - 1) % lines;
+    int depth = (i - 1) / lines + 1;
+    float jitter = (rng.nextFloat() - 0.5f) * 0.6f / (float)lines;
+    float angle = 2.0f * kPi * (float)line / (float)lines + jitter;
+    net.x[i] = cx + std::cos(angle) * step * (float)depth;
+    net.y[i] = cy + std::sin(angle) * step * (float)depth;
+
+    tracks.push_back(std::make_pair(depth == 1 ? 0 : i - lines, i));
+
+    // Ring line: this spoke to the next one, closing the ring on the last
+    if (depth % ringEvery == 0 && lines > 1) {
+      int next = line + 1 < lines ? i + 1 : i - (lines - 1);
+      bool closes = line + 1 == lines;
+      if (next < n && (!closes || lines > 2))
+        tracks.push_back(std::make_pair(i, next));
+    }
+  }
+}
+
+void layoutScaleFree(GeneratedNetwork &net, const NetworkGenOptions &options,
+                     Rng &rng, TrackList &tracks) {
+  int n = net.stationCount;
+  int m = std::max(1, std::min(options.degree, kMaxGeneratedConnections / 2));
+  std::vector<int> degree(n, 0);
+  std::vector<uint32_t> endpoints; // every track end, for preferential picks
+  endpoints.reserve((size_t)n * m * 2);
+
+  auto link = [&](int a, int b) {
+    tracks.push_back(std::make_pair(a, b));
+    endpoints.push_back(a);
+    endpoints.push_back(b);
+    degree[a]++;
+    degree[b]++;
+  };
+
+  // Seed with a small fully connected core
+  int core = std::min(n, m + 1);
+  for (int a = 0; a < core; ++a) {
+    for (int b = a + 1; b < core; ++b)
+      link(a, b);
+  }
+
+  std::vector<int> chosen;
+  for (int i = core; i < n; ++i) {
+    chosen.clear();
+    int wanted = std::min(m, i);
+    for (int attempt = 0; (int)chosen.size() < wanted; ++attempt) {
+      // Picking a track end uniformly picks a station by its degree. Full
+      // stations are skipped; after many misses fall back to any station.
+      int target = attempt < 64 && !endpoints.empty()
+                       ? (int)endpoints[rng.nextBelow((uint32_t)endpoints.size())]
+                       : (int)rng.nextBelow((uint32_t)i);
+      if (degree[target] >= kMaxGeneratedConnections ||
+          std::find(chosen.begin(), chosen.end(), target) != chosen.end())
+        continue;
+      chosen.push_back(target);
+    }
+    for (int target : chosen)
+      link(i, target);
+  }
+
+  for (int i = 0; i < n; ++i) {
+    net.x[i] = rng.nextFloat() * options.width;
+    net.y[i] = rng.nextFloat() * options.height;
+  }
+}
+
+/**
+ * @brief Buffers output and hands it to the stream in large blocks
+ */
+class BlockWriter {
+public:
+  explicit BlockWriter(std::ostream &stream) : out(stream), used(0) {}
+  ~BlockWriter() { flush(); }
+
+  void put(const char *s, size_t n) {
+    if (used + n > sizeof(buffer))
+      flush();
+    if (n > sizeof(buffer)) {
+      out.write(s, (std::streamsize)n);
+      return;
+    }
+    std::memcpy(buffer + used, s, n);
+    used += n;
+  }
+  void put(const char *s) { put(s, std::strlen(s)); }
+
+  void putUint(uint32_t v) {
+    char digits[10];
+    int n = 0;
+    do {
+      digits[n++] = (char)('0' + v % 10);
+      v /= 10;
+    } while (v);
+    char text[10];
+    for (int i = 0; i < n; ++i)
+      text[i] = digits[n - 1 - i];
+    put(text, n);
+  }
+
+  void putCoordinate(float v) {
+    char text[32];
+    int n = std::snprintf(text, sizeof(text), "%.1f", v);
+    put(text, (size_t)n);
+  }
+
+  void flush() {
+    out.write(buffer, (std::streamsize)used);
+    used = 0;
+  }
+
+private:
+  std::ostream &out;
+  char buffer[1 << 16];
+  size_t used;
+};
+
+} // namespace
+
+const std::vector<std::string> &networkTopologyNames() {
+  static const std::vector<std::string> names = {"grid", "radial",
+                                                 "scale-free"};
+  return names;
+}
+
+std::string generatedStationName(int i) {
+  return "Station " + std::to_string(i);
+}
+
+GeneratedNetwork generateNetwork(const NetworkGenOptions &options) {
+  if (options.stations < 1)
+    throw std::invalid_argument("a network needs at least one station");
+
+  GeneratedNetwork net;
+  net.stationCount = options.stations;
+  net.x.assign(options.stations, 0.0f);
+  net.y.assign(options.stations, 0.0f);
+
+  Rng rng(options.seed);
+  TrackList tracks;
+  if (options.topology == "grid")
+    layoutGrid(net, options, tracks);
+  else if (options.topology == "radial")
+    layoutRadial(net, options, rng, tracks);
+  else if (options.topology == "scale-free")
+    layoutScaleFree(net, options, rng, tracks);
+  else
+    throw std::invalid_argument("unknown topology '" + options.topology +
+                                "'");
+
+  // Each track becomes a connection both ways, grouped by station
+  net.edgeStart.assign(options.stations + 1, 0);
+  for (const auto &track : tracks) {
+    net.edgeStart[track.first + 1]++;
+    net.edgeStart[track.second + 1]++;
+  }
+  for (int i = 0; i < options.stations; ++i)
+    net.edgeStart[i + 1] += net.edgeStart[i];
+  net.edges.resize(tracks.size() * 2);
+  std::vector<uint32_t> fill(net.edgeStart.begin(), net.edgeStart.end() - 1);
+  for (const auto &track : tracks) {
+    net.edges[fill[track.first]++] = track.second;
+    net.edges[fill[track.second]++] = track.first;
+  }
+  return net;
+}
+
+void writeNetworkJson(const GeneratedNetwork &net, std::ostream &out,
+                      bool coordinates) {
+  BlockWriter w(out);
+  w.put("{\n  \"stations\": [\n");
+  for (int i = 0; i < net.stationCount; ++i) {
+    w.put(i ? ",\n    {\"name\": \"Station " : "    {\"name\": \"Station ");
+    w.putUint((uint32_t)i);
+    w.put("\"");
+    if (coordinates) {
+      w.put(", \"x\": ");
+      w.putCoordinate(net.x[i]);
+      w.put(", \"y\": ");
+      w.putCoordinate(net.y[i]);
+    }
+    w.put(", \"connections\": [");
+    for (uint32_t e = net.edgeStart[i]; e < net.edgeStart[i + 1]; ++e) {
+      w.put(e == net.edgeStart[i] ? "\"Station " : ", \"Station ");
+      w.putUint(net.edges[e]);
+      w.put("\"");
+    }
+    w.put("]}");
+  }
+  w.put("\n  ]\n}\n");
+}
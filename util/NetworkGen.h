@@ -0,0 +1,76 @@
+#ifndef NETWORK_GEN_H
+#define NETWORK_GEN_H
+
+#include <cstdint>
+#include <ostream>
+#include <string>
+#include <vector>
+
+/**
+ * @brief Settings for generateNetwork()
+ */
+struct NetworkGenOptions {
+  std::string topology = "grid"; // grid, radial or scale-free
+  int stations = 100;
+  uint64_t seed = 1;
+  int lines = 8;  // radial: spokes leaving the hub
+  int ringEvery = 4; // radial: a ring line every this many stops out
+  int degree = 2; // scale-free: connections made by each new station
+  float width = 800.0f;  // area the coordinates are laid out in
+  float height = 600.0f;
+};
+
+/**
+ * @brief A generated station graph, with an undirected track stored as a
+ * connection in each direction (as in assets/metro3.json)
+ */
+struct GeneratedNetwork {
+  int stationCount = 0;
+  std::vector<uint32_t> edgeStart; // CSR: connections of station i are
+  std::vector<uint32_t> edges;     // edges[edgeStart[i] .. edgeStart[i+1])
+  std::vector<float> x;
+  std::vector<float> y;
+
+  size_t getEdgeCount() const { return edges.size(); }
+};
+
+/// No station is given more connections than this, since routes store the
+/// index of a connection in a byte (see RoutingTable)
+constexpr int kMaxGeneratedConnections = 254;
+
+/**
+ * @brief Names the topologies generateNetwork() accepts
+ */
+const std::vector<std::string> &networkTopologyNames();
+
+/**
+ * @brief Generate a synthetic network
+ *
+ *  - grid: a square lattice, each station linked to its four neighbours
+ *  - radial: a hub with `lines` spokes, and ring lines linking the spokes
+ *    every `ringEvery` stops out from the hub
+ *  - scale-free: Barabasi-Albert preferential attachment, each new station
+ *    linking to `degree` existing ones, so a few hubs get most connections
+ *
+ * The same options and seed always give the same network.
+ * @throws std::invalid_argument on an unknown topology or bad size
+ */
+GeneratedNetwork generateNetwork(const NetworkGenOptions &options);
+
+/**
+ * @brief Name of generated station i
+ */
+std::string generatedStationName(int i);
+
+/**
+ * @brief Write a network as JSON in the "stations"/"connections" schema
+ * the loader reads, one station per line
+ * @param coordinates Also write each station's "x" and "y"
+ *
+ * Output goes through a fixed-size buffer straight to the stream, with no
+ * per-station strings or document held in memory.
+ */
+void writeNetworkJson(const GeneratedNetwork &network, std::ostream &out,
+                      bool coordinates);
+
+#endif // NETWORK_GEN_H
@@ -0,0 +1,393 @@
+#include "NetworkImage.h"
+#include "JsonReader.h"
+#include "Profiler.h"
+#include "StringInterner.h"
+#include <cstdio>
+#include <cstring>
+#include <filesystem>
+#include <fstream>
+#include <iterator>
+#include <stdexcept>
+#include <utility>
+
+#ifndef _WIN32
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#endif
+
+static const char kMagic[8] = {'M', 'E', 'T', 'R', 'O', 'I', 'M', 'G'};
+
+NetworkImage::NetworkImage() : data(nullptr), size(0), mapped(false) {}
+
+NetworkImage::~NetworkImage() { release(); }
+
+NetworkImage::NetworkImage(NetworkImage &&other) noexcept
+    : data(nullptr), size(0), mapped(false) {
+  *this = std::move(other);
+}
+
+NetworkImage &NetworkImage::operator=(NetworkImage &&other) noexcept {
+  if (this != &other) {
+    release();
+    owned = std::move(other.owned);
+    data = other.mapped ? other.data : owned.data();
+    size = other.size;
+    mapped = other.mapped;
+    other.data = nullptr;
+    other.size = 0;
+    other.mapped = false;
+  }
+  return *this;
+}
+
+void NetworkImage::release() {
+#ifndef _WIN32
+  if (mapped && data)
+    munmap(const_cast<char *>(data), size);
+#endif
+  data = nullptr;
+  size = 0;
+  mapped = false;
+  owned.clear();
+}
+
+uint64_t NetworkImage::hashBytes(const void *bytes, size_t length,
+                                 uint64_t hash) {
+  const unsigned char *p = static_cast<const unsigned char *>(bytes);
+  for (size_t i = 0; i < length; ++i) {
+    hash ^= p[i];
+    hash *= 1099511628211ULL;
+  }
+  return hash;
+}
+
+namespace {
+
+/**
+ * @brief One element of the "stations" array as it is being read
+ */
+struct PendingStation {
+  bool hasName = false;
+  uint32_t symbol = 0;
+  bool hasX = false;
+  bool hasY = false;
+  float x = 0.0f;
+  float y = 0.0f;
+  std::vector<uint32_t> connections; // target symbols
+};
+
+/**
+ * @brief Read one station object; its BEGIN_OBJECT has been consumed
+ */
+void readStation(JsonReader &reader, StringInterner &symbols,
+                 PendingStation &out) {
+  out = PendingStation();
+  while (reader.next() == JsonReader::KEY) {
+    const std::string &key = reader.text();
+    if (key == "name") {
+      JsonReader::Token token = reader.next();
+      if (token == JsonReader::STRING) {
+        out.hasName = true;
+        out.symbol = symbols.intern(reader.text());
+      } else {
+        out.hasName = false;
+        if (token == JsonReader::BEGIN_OBJECT ||
+            token == JsonReader::BEGIN_ARRAY)
+          reader.skipContainer();
+      }
+    } else if (key == "x" || key == "y") {
+      bool isX = key == "x";
+      JsonReader::Token token = reader.next();
+      bool numeric = token == JsonReader::NUMBER;
+      (isX ? out.hasX : out.hasY) = numeric;
+      if (numeric)
+        (isX ? out.x : out.y) = (float)reader.number();
+      else if (token == JsonReader::BEGIN_OBJECT ||
+               token == JsonReader::BEGIN_ARRAY)
+        reader.skipContainer();
+    } else if (key == "connections") {
+      out.connections.clear();
+      JsonReader::Token token = reader.next();
+      if (token == JsonReader::BEGIN_ARRAY) {
+        for (token = reader.next(); token != JsonReader::END_ARRAY;
+             token = reader.next()) {
+          if (token == JsonReader::STRING)
+            out.connections.push_back(symbols.intern(reader.text()));
+          else if (token == JsonReader::BEGIN_OBJECT ||
+                   token == JsonReader::BEGIN_ARRAY)
+            reader.skipContainer();
+        }
+      } else if (token == JsonReader::BEGIN_OBJECT) {
+        reader.skipContainer();
+      }
+    } else {
+      reader.skipValue();
+    }
+  }
+}
+
+} // namespace
+
+NetworkImage NetworkImage::compile(std::istream &in, uint64_t sourceHash,
+                                   std::vector<std::string> *warnings) {
+  JsonReader reader(in);
+  // Connections may name a station before it is defined, so they are kept
+  // as pairs of interned names and only resolved to station ids once the
+  // whole file has been read
+  StringInterner symbols;
+  std::vector<Station> stations;
+  std::vector<uint32_t> stationSymbol;
+  // Connections in file order, as (from, to) symbols
+  std::vector<std::pair<uint32_t, uint32_t>> links;
+
+  if (reader.next() != JsonReader::BEGIN_OBJECT)
+    reader.fail("expected the network to be a JSON object");
+
+  PendingStation pending;
+  while (reader.next() == JsonReader::KEY) {
+    if (reader.text() != "stations") {
+      reader.skipValue();
+      continue;
+    }
+
+    JsonReader::Token token = reader.next();
+    if (token != JsonReader::BEGIN_ARRAY) {
+      if (token == JsonReader::BEGIN_OBJECT)
+        reader.skipContainer();
+      continue;
+    }
+
+    for (token = reader.next(); token != JsonReader::END_ARRAY;
+         token = reader.next()) {
+      if (token != JsonReader::BEGIN_OBJECT) {
+        if (token == JsonReader::BEGIN_ARRAY)
+          reader.skipContainer();
+        continue;
+      }
+
+      readStation(reader, symbols, pending);
+      if (!pending.hasName)
+        continue;
+
+      Station station = {0, 0, 0.0f, 0.0f, 0};
+      if (pending.hasX && pending.hasY) {
+        station.x = pending.x;
+        station.y = pending.y;
+        station.flags |= kHasPosition;
+      }
+      stations.push_back(station);
+      stationSymbol.push_back(pending.symbol);
+      for (uint32_t target : pending.connections)
+        links.push_back(std::make_pair(pending.symbol, target));
+    }
+  }
+  if (reader.next() != JsonReader::END)
+    reader.fail("unexpected data after the end of the document");
+
+  // A repeated name refers to its last definition, as it always has
+  const uint32_t kUndefined = 0xFFFFFFFFu;
+  std::vector<uint32_t> stationOf(symbols.size(), kUndefined);
+  for (uint32_t id = 0; id < (uint32_t)stations.size(); ++id)
+    stationOf[stationSymbol[id]] = id;
+
+  // Names blob: every distinct station name once
+  std::string names;
+  std::vector<uint32_t> nameOffset(symbols.size(), kUndefined);
+  for (uint32_t id = 0; id < (uint32_t)stations.size(); ++id) {
+    uint32_t symbol = stationSymbol[id];
+    if (nameOffset[symbol] == kUndefined) {
+      nameOffset[symbol] = (uint32_t)names.size();
+      names.append(symbols.get(symbol));
+      names.push_back('\0');
+    }
+    stations[id].nameOffset = nameOffset[symbol];
+    stations[id].nameLength = (uint32_t)symbols.get(symbol).size();
+  }
+
+  // CSR adjacency by counting sort, keeping file order within a station
+  std::vector<uint32_t> edgeStart(stations.size() + 1, 0);
+  size_t edgeCount = 0;
+  for (const auto &link : links) {
+    if (stationOf[link.second] != kUndefined) {
+      edgeStart[stationOf[link.first] + 1]++;
+      edgeCount++;
+    } else if (warnings) {
+      warnings->push_back("Connection to unknown station '" +
+                          symbols.get(link.second) + "' for station '" +
+                          symbols.get(link.first) + "'");
+    }
+  }
+  for (size_t i = 0; i < stations.size(); ++i)
+    edgeStart[i + 1] += edgeStart[i];
+  std::vector<uint32_t> edges(edgeCount);
+  std::vector<uint32_t> fill(edgeStart.begin(), edgeStart.end() - 1);
+  for (const auto &link : links) {
+    uint32_t to = stationOf[link.second];
+    if (to != kUndefined)
+      edges[fill[stationOf[link.first]]++] = to;
+  }
+
+  Header head;
+  std::memcpy(head.magic, kMagic, sizeof(kMagic));
+  head.version = kVersion;
+  head.stationCount = (uint32_t)stations.size();
+  head.edgeCount = (uint32_t)edges.size();
+  head.nameBytes = (uint32_t)names.size();
+  head.sourceHash = sourceHash;
+
+  NetworkImage image;
+  std::vector<char> &out = image.owned;
+  out.resize(sizeof(Header) + stations.size() * sizeof(Station) +
+             edgeStart.size() * sizeof(uint32_t) +
+             edges.size() * sizeof(uint32_t) + names.size());
+  char *at = out.data();
+  auto put = [&at](const void *src, size_t bytes) {
+    if (bytes > 0)
+      std::memcpy(at, src, bytes);
+    at += bytes;
+  };
+  put(&head, sizeof(head));
+  put(stations.data(), stations.size() * sizeof(Station));
+  put(edgeStart.data(), edgeStart.size() * sizeof(uint32_t));
+  put(edges.data(), edges.size() * sizeof(uint32_t));
+  put(names.data(), names.size());
+
+  image.data = out.data();
+  image.size = out.size();
+  return image;
+}
+
+bool NetworkImage::validate() const {
+  if (size < sizeof(Header))
+    return false;
+  const Header *h = header();
+  if (std::memcmp(h->magic, kMagic, sizeof(kMagic)) != 0 ||
+      h->version != kVersion)
+    return false;
+
+  size_t expected = sizeof(Header) + (size_t)h->stationCount * sizeof(Station) +
+                    ((size_t)h->stationCount + 1) * sizeof(uint32_t) +
+                    (size_t)h->edgeCount * sizeof(uint32_t) + h->nameBytes;
+  if (expected != size)
+    return false;
+
+  const uint32_t *start = edgeStart();
+  if (start[0] != 0 || start[h->stationCount] != h->edgeCount)
+    return false;
+  for (uint32_t i = 0; i < h->stationCount; ++i) {
+    const Station &s = stationTable()[i];
+    if (start[i] > start[i + 1] ||
+        (size_t)s.nameOffset + s.nameLength > h->nameBytes)
+      return false;
+  }
+  for (uint32_t e = 0; e < h->edgeCount; ++e) {
+    if (edges()[e] >= h->stationCount)
+      return false;
+  }
+  return true;
+}
+
+NetworkImage NetworkImage::map(const std::string &path) {
+  NetworkImage image;
+#ifndef _WIN32
+  int fd = ::open(path.c_str(), O_RDONLY);
+  if (fd < 0)
+    return image;
+  struct stat info;
+  if (fstat(fd, &info) == 0 && info.st_size > 0) {
+    void *mem =
+        mmap(nullptr, (size_t)info.st_size, PROT_READ, MAP_PRIVATE, fd, 0);
+    if (mem != MAP_FAILED) {
+      image.data = static_cast<const char *>(mem);
+      image.size = (size_t)info.st_size;
+      image.mapped = true;
+    }
+  }
+  ::close(fd);
+#else
+  std::ifstream in(path, std::ios::binary);
+  if (!in)
+    return image;
+  image.owned.assign(std::istreambuf_iterator<char>(in),
+                     std::istreambuf_iterator<char>());
+  image.data = image.owned.data();
+  image.size = image.owned.size();
+#endif
+  if (!image.validate())
+    image.release();
+  return image;
+}
+
+bool NetworkImage::save(const std::string &path) const {
+  std::string temp = path + ".tmp";
+  {
+    std::ofstream out(temp, std::ios::binary | std::ios::trunc);
+    if (!out)
+      return false;
+    out.write(data, (std::streamsize)size);
+    if (!out)
+      return false;
+  }
+  std::error_code error;
+  std::filesystem::rename(temp, path, error);
+  return !error;
+}
+
+NetworkImage loadNetworkImage(const std::string &jsonPath,
+                              const std::string &cacheDir,
+                              std::vector<std::string> *warnings,
+                              bool *fromCache) {
+  std::ifstream in(jsonPath, std::ios::binary);
+  if (!in.is_open())
+    throw std::runtime_error("Could not open " + jsonPath);
+
+  // Hash in chunks, so even the cache check never holds the whole file
+  uint64_t hash = NetworkImage::kHashSeed;
+  {
+    ProfileScope scope("load.hash");
+    std::vector<char> chunk(64 * 1024);
+    while (in) {
+      in.read(chunk.data(), (std::streamsize)chunk.size());
+      hash = NetworkImage::hashBytes(chunk.data(), (size_t)in.gcount(), hash);
+    }
+  }
+
+  std::string cachePath;
+  if (!cacheDir.empty()) {
+    char key[32];
+    std::snprintf(key, sizeof(key), "%016llx-v%u.netimg",
+                  (unsigned long long)hash, NetworkImage::kVersion);
+    cachePath = (std::filesystem::path(cacheDir) / key).string();
+
+    ProfileScope scope("load.map");
+    NetworkImage cached = NetworkImage::map(cachePath);
+    if (!cached.empty() && cached.getSourceHash() == hash) {
+      if (fromCache)
+        *fromCache = true;
+      return cached;
+    }
+  }
+
+  in.clear();
+  in.seekg(0);
+  NetworkImage image;
+  try {
+    ProfileScope scope("load.compile");
+    image = NetworkImage::compile(in, hash, warnings);
+  } catch (const JsonParseError &e) {
+    throw std::runtime_error(jsonPath + ": " + e.what());
+  }
+
+  if (!cachePath.empty()) {
+    // A cache that cannot be written only costs a recompile next time
+    std::error_code error;
+    std::filesystem::create_directories(cacheDir, error);
+    if (!error)
+      image.save(cachePath);
+  }
+  if (fromCache)
+    *fromCache = false;
+  return image;
+}
@@ -0,0 +1,158 @@
+#ifndef NETWORK_IMAGE_H
+#define NETWORK_IMAGE_H
+
+#include <cstddef>
+#include <cstdint>
+#include <istream>
+#include <string>
+#include <string_view>
+#include <vector>
+
+/**
+ * @brief Compiled, read-only form of a network description.
+ *
+ * The JSON network is compiled once into a flat binary image that can be
+ * used straight from memory without parsing:
+ *
+ *   Header
+ *   Station[stationCount]          name (offset, length), x, y, flags
+ *   uint32 edgeStart[stationCount + 1]
+ *   uint32 edges[edgeCount]        CSR adjacency, station ids
+ *   char   names[nameBytes]        every distinct name once, NUL-terminated
+ *
+ * The JSON is compiled in a single forward pass over a JsonReader, so
+ * memory stays proportional to the image rather than to a document tree.
+ * Connections are resolved to station ids at compile time. Station
+ * positions are only stored when the JSON gives them; the rest are placed
+ * at load time, since placement depends on the seed and canvas size.
+ *
+ * Images are cached on disk under the FNV-1a hash of the JSON bytes, so an
+ * unchanged network is only ever compiled once. A cached image is mapped
+ * into memory rather than read.
+ */
+class NetworkImage {
+public:
+  /// Bumped whenever the layout below changes; part of the cache key
+  static constexpr uint32_t kVersion = 1;
+
+  struct Header {
+    char magic[8];
+    uint32_t version;
+    uint32_t stationCount;
+    uint32_t edgeCount;
+    uint32_t nameBytes;
+    uint64_t sourceHash;
+  };
+
+  struct Station {
+    uint32_t nameOffset;
+    uint32_t nameLength;
+    float x;
+    float y;
+    uint32_t flags;
+  };
+
+  /// Station::flags bit: x and y were given in the JSON
+  static constexpr uint32_t kHasPosition = 1;
+
+  NetworkImage();
+  ~NetworkImage();
+  NetworkImage(NetworkImage &&other) noexcept;
+  NetworkImage &operator=(NetworkImage &&other) noexcept;
+  NetworkImage(const NetworkImage &) = delete;
+  NetworkImage &operator=(const NetworkImage &) = delete;
+
+  /**
+   * @brief Compile a JSON network description
+   * @param in Stream positioned at the start of the JSON
+   * @param sourceHash hashBytes() of the JSON, recorded in the header
+   * @param warnings If given, receives a line per connection to an unknown
+   * station
+   * @throws JsonParseError (with line and column) if the JSON is malformed
+   */
+  static NetworkImage compile(std::istream &in, uint64_t sourceHash,
+                              std::vector<std::string> *warnings = nullptr);
+
+  /**
+   * @brief Map an image file into memory
+   * @return An empty image if the file is missing or not a valid image
+   */
+  static NetworkImage map(const std::string &path);
+
+  /**
+   * @brief Write the image to a file (via a temporary file and a rename,
+   * so readers never see a partial image)
+   * @return false on I/O errors
+   */
+  bool save(const std::string &path) const;
+
+  bool empty() const { return size == 0; }
+  uint64_t getSourceHash() const { return header()->sourceHash; }
+  size_t getByteSize() const { return size; }
+
+  int getStationCount() const { return (int)header()->stationCount; }
+  int getEdgeCount() const { return (int)header()->edgeCount; }
+  const Station &getStation(int id) const { return stationTable()[id]; }
+  std::string_view getName(int id) const {
+    const Station &s = getStation(id);
+    return std::string_view(nameBlob() + s.nameOffset, s.nameLength);
+  }
+  bool hasPosition(int id) const {
+    return (getStation(id).flags & kHasPosition) != 0;
+  }
+
+  // CSR adjacency: the connections of station id are
+  // edges()[edgeStart()[id]] .. edges()[edgeStart()[id + 1] - 1]
+  const uint32_t *edgeStart() const {
+    return reinterpret_cast<const uint32_t *>(
+        stationTable() + header()->stationCount);
+  }
+  const uint32_t *edges() const {
+    return edgeStart() + header()->stationCount + 1;
+  }
+
+  /**
+   * @brief FNV-1a hash of a byte range, used as the cache key. Pass the
+   * previous result as hash to continue hashing a stream chunk by chunk.
+   */
+  static constexpr uint64_t kHashSeed = 14695981039346656037ULL;
+  static uint64_t hashBytes(const void *data, size_t size,
+                            uint64_t hash = kHashSeed);
+
+private:
+  const char *data; // start of the image, owned or mapped
+  size_t size;
+  std::vector<char> owned; // backing store of a compiled image
+  bool mapped;
+
+  void release();
+  bool validate() const;
+
+  const Header *header() const {
+    return reinterpret_cast<const Header *>(data);
+  }
+  const Station *stationTable() const {
+    return reinterpret_cast<const Station *>(data + sizeof(Header));
+  }
+  const char *nameBlob() const {
+    return reinterpret_cast<const char *>(edges() + header()->edgeCount);
+  }
+};
+
+/**
+ * @brief Get the compiled image of a JSON network, compiling and caching
+ * it if no valid cached image exists
+ * @param jsonPath Path to the JSON network description
+ * @param cacheDir Directory holding cached images (created if missing);
+ * empty to compile without caching
+ * @param warnings See NetworkImage::compile(); only filled on a compile
+ * @param fromCache If given, set to whether the image came from the cache
+ * @throws std::runtime_error if the JSON cannot be read or is malformed;
+ * syntax errors give the path, line and column
+ */
+NetworkImage loadNetworkImage(const std::string &jsonPath,
+                              const std::string &cacheDir,
+                              std::vector<std::string> *warnings = nullptr,
+                              bool *fromCache = nullptr);
+
+#endif // NETWORK_IMAGE_H
@@ -0,0 +1,138 @@
+#ifndef NETWORK_LAYER_H
+#define NETWORK_LAYER_H
+
+#include "Simulation.h"
+#include "VisualAsset.h"
+#include <algorithm>
+#include <cstdint>
+#include <sgg/graphics.h>
+#include <utility>
+#include <vector>
+
+/**
+ * @brief Draws the whole track network and every station disk.
+ *
+ * The network JSON lists each connection from both ends, so the layer keeps
+ * a deduplicated undirected edge list, plus the segment end points, and
+ * only rebuilds them when the simulation reports that stations were added,
+ * connected or moved, or a station is hidden. Draws are issued grouped by
+ * brush: all track segments first, then all station disks. Per-station
+ * extras such as the hover label are left to the Station views.
+ */
+class NetworkLayer : public VisualAsset {
+private:
+  struct Segment {
+    float x1, y1, x2, y2;
+  };
+
+  Simulation &sim;
+  float stationRadius;
+  graphics::Brush lineBrush;
+  graphics::Brush stationBrush;
+
+  std::vector<std::pair<int, int>> edges; // undirected, first < second
+  std::vector<Segment> segments;          // cached geometry of edges
+  std::vector<uint8_t> hidden;            // by station id
+
+  uint64_t builtTopology;
+  uint64_t builtLayout;
+  bool visibilityDirty;
+
+  void rebuildEdges() {
+    const std::vector<SimStation> &stations = sim.getStations();
+    edges.clear();
+    for (int a = 0; a < (int)stations.size(); ++a) {
+      for (int b : stations[a].next) {
+        if (a != b)
+          edges.push_back(std::make_pair(std::min(a, b), std::max(a, b)));
+      }
+    }
+    std::sort(edges.begin(), edges.end());
+    edges.erase(std::unique(edges.begin(), edges.end()), edges.end());
+    hidden.resize(stations.size(), 0);
+  }
+
+  void rebuildGeometry() {
+    segments.clear();
+    segments.reserve(edges.size());
+    for (const auto &e : edges) {
+      if (hidden[e.first] || hidden[e.second])
+        continue;
+      const SimStation &a = sim.getStation(e.first);
+      const SimStation &b = sim.getStation(e.second);
+      segments.push_back(Segment{a.x, a.y, b.x, b.y});
+    }
+  }
+
+public:
+  explicit NetworkLayer(Simulation &simulation, float r = 15.0f)
+      : VisualAsset(0.0f, 0.0f), sim(simulation), stationRadius(r),
+        builtTopology(~0ULL), builtLayout(~0ULL), visibilityDirty(false) {
+    lineBrush.outline_opacity = 1.0f;
+    lineBrush.outline_width = 0.8f;
+    lineBrush.outline_color[0] = 0.5f;
+    lineBrush.outline_color[1] = 0.5f;
+    lineBrush.outline_color[2] = 0.5f;
+
+    stationBrush.fill_color[0] = 0.2f;
+    stationBrush.fill_color[1] = 0.6f;
+    stationBrush.fill_color[2] = 0.9f;
+    stationBrush.outline_opacity = 1.0f;
+    stationBrush.outline_width = 3.0f;
+  }
+
+  /**
+   * @brief Show or hide a station and its connections. Marks the layer
+   * dirty, since the simulation itself has not changed.
+   */
+  void setStationVisible(int id, bool visible) {
+    if (id >= (int)hidden.size())
+      hidden.resize(id + 1, 0);
+    hidden[id] = visible ? 0 : 1;
+    visibilityDirty = true;
+    markDirty();
+  }
+
+  /**
+   * @brief Bring the cached edges up to date with the simulation
+   */
+  void update(int ms, const graphics::MouseState &mouse) override {
+    (void)ms;
+    (void)mouse;
+
+    bool topologyChanged = builtTopology != sim.getTopologyVersion();
+    if (topologyChanged) {
+      rebuildEdges();
+      builtTopology = sim.getTopologyVersion();
+    }
+    if (topologyChanged || visibilityDirty ||
+        builtLayout != sim.getLayoutVersion()) {
+      rebuildGeometry();
+      builtLayout = sim.getLayoutVersion();
+      visibilityDirty = false;
+    }
+  }
+
+  void draw() override {
+    if (!active)
+      return;
+
+    // Tracks, one brush for all segments
+    for (const Segment &s : segments) {
+      graphics::drawLine(s.x1, s.y1, s.x2, s.y2, lineBrush);
+    }
+
+    // Stations, one brush for all disks
+    const std::vector<SimStation> &stations = sim.getStations();
+    for (size_t i = 0; i < stations.size(); ++i) {
+      if (i < hidden.size() && hidden[i])
+        continue;
+      graphics::drawDisk(stations[i].x, stations[i].y, stationRadius,
+                         stationBrush);
+    }
+  }
+
+  size_t getEdgeCount() const { return edges.size(); }
+};
+
+#endif // NETWORK_LAYER_H
@@ -0,0 +1,103 @@
+#include "NetworkLoader.h"
+#include "Placement.h"
+#include "Profiler.h"
+#include <iostream>
+#include <new>
+#include <stdexcept>
+#include <string>
+#include <vector>
+
+const char *const kDefaultNetworkCacheDir = ".metro-cache";
+
+void loadNetwork(Simulation &sim, const std::string &path, int width,
+                 int height, const std::string &cacheDir) {
+  ProfileScope scope("load");
+  std::vector<std::string> warnings;
+  bool fromCache = false;
+  NetworkImage image = loadNetworkImage(path, cacheDir, &warnings, &fromCache);
+
+  if (sim.isDebugMode()) {
+    std::cout << (fromCache ? "Mapped cached network image for "
+                            : "Compiled network image for ")
+              << path << " (" << image.getByteSize() << " bytes)"
+              << std::endl;
+    for (const std::string &warning : warnings)
+      std::cerr << "Warning: " << warning << std::endl;
+  }
+
+  loadNetwork(sim, image, width, height);
+}
+
+static void populate(Simulation &sim, const NetworkImage &image, int width,
+                     int height) {
+  const float MIN_SPACING = 100.0f; // Minimum distance between stations
+
+  int count = image.getStationCount();
+  const uint32_t *start = image.edgeStart();
+  const uint32_t *edges = image.edges();
+  for (int i = 0; i < count; ++i) {
+    if (start[i + 1] - start[i] > (uint32_t)RoutingTable::kMaxConnections)
+      throw std::runtime_error(
+          "Station '" + std::string(image.getName(i)) + "' has " +
+          std::to_string(start[i + 1] - start[i]) +
+          " connections; at most " +
+          std::to_string(RoutingTable::kMaxConnections) + " are supported");
+  }
+
+  std::vector<PlacementPoint> fixed;
+  for (int i = 0; i < count; ++i) {
+    if (image.hasPosition(i)) {
+      const NetworkImage::Station &s = image.getStation(i);
+      fixed.push_back(PlacementPoint{s.x, s.y});
+    }
+  }
+
+  // Place the rest with a guaranteed minimum spacing, away from the edges
+  // and from the title/score at the top
+  Rng rng = sim.makeRng(Rng::PLACEMENT);
+  int toPlace = count - (int)fixed.size();
+  std::vector<PlacementPoint> placed;
+  {
+    ProfileScope scope("load.place");
+    placed = poissonDiskPlacement(toPlace, 50.0f, 150.0f, width - 50.0f,
+                                  height - 50.0f, MIN_SPACING, rng, fixed);
+  }
+  if (sim.isDebugMode()) {
+    std::cout << "Placed " << toPlace << " stations, " << fixed.size()
+              << " had explicit coordinates" << std::endl;
+  }
+
+  // Station ids in the image become simulation ids, offset by whatever the
+  // simulation already held
+  ProfileScope stationsScope("load.stations");
+  int base = (int)sim.getStations().size();
+  size_t next_placed = 0;
+  for (int i = 0; i < count; ++i) {
+    const NetworkImage::Station &s = image.getStation(i);
+    PlacementPoint p =
+        image.hasPosition(i) ? PlacementPoint{s.x, s.y} : placed[next_placed++];
+    sim.addStation(image.getName(i), p.x, p.y);
+  }
+
+  for (int i = 0; i < count; ++i) {
+    for (uint32_t e = start[i]; e < start[i + 1]; ++e)
+      sim.connect(base + i, base + (int)edges[e]);
+  }
+
+  // Topology is final: index it for routing once
+  sim.buildRoutes();
+}
+
+void loadNetwork(Simulation &sim, const NetworkImage &image, int width,
+                 int height) {
+  try {
+    populate(sim, image, width, height);
+  } catch (const std::bad_alloc &) {
+    // Leave no half-loaded network behind
+    sim.clear();
+    throw std::runtime_error(
+        "Not enough memory to load a network of " +
+        std::to_string(image.getStationCount()) + " stations and " +
+        std::to_string(image.getEdgeCount()) + " connections");
+  }
+}
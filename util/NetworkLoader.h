@@ -0,0 +1,40 @@
+#ifndef NETWORK_LOADER_H
+#define NETWORK_LOADER_H
+
+#include "NetworkImage.h"
+#include "Simulation.h"
+#include <string>
+
+/// Where compiled network images are cached by default
+extern const char *const kDefaultNetworkCacheDir;
+
+/**
+ * @brief Load a metro network description into a simulation
+ * @param sim Simulation to populate (stations and connections are appended)
+ * @param path Path to a JSON file with a "stations" array
+ * @param width Width of the area stations are placed in
+ * @param height Height of the area stations are placed in
+ * @param cacheDir Directory for compiled network images, see
+ * loadNetworkImage(); empty to always compile
+ * @throws std::runtime_error if the file cannot be opened or is malformed
+ *
+ * Stations with numeric "x" and "y" fields keep those coordinates. The
+ * others are placed by Poisson-disk sampling inside the given area, leaving
+ * room at the top for the title and score, at least 100 units apart from
+ * every other station. Placement draws from the simulation's
+ * Rng::PLACEMENT stream, so set the seed first.
+ */
+void loadNetwork(Simulation &sim, const std::string &path, int width,
+                 int height,
+                 const std::string &cacheDir = kDefaultNetworkCacheDir);
+
+/**
+ * @brief Populate a simulation from an already compiled network image
+ * @throws std::runtime_error if a station has more than
+ * RoutingTable::kMaxConnections connections, or the network does not fit
+ * in memory (the simulation is then cleared)
+ */
+void loadNetwork(Simulation &sim, const NetworkImage &image, int width,
+                 int height);
+
+#endif // NETWORK_LOADER_H
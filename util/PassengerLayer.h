@@ -0,0 +1,79 @@
+#ifndef PASSENGER_LAYER_H
+#define PASSENGER_LAYER_H
+
+#include "PassengerStore.h"
+#include "Simulation.h"
+#include "VisualAsset.h"
+#include <sgg/graphics.h>
+
+/**
+ * @brief Draws every passenger of a Simulation as a single VisualAsset.
+ *
+ * Passengers have no per-rider view objects: the layer sweeps the
+ * PassengerStore columns and draws each rider with the flyweight brush of
+ * its state. Positions are laid out by the Station and Train views that
+ * currently hold the rider.
+ */
+class PassengerLayer : public VisualAsset {
+private:
+  Simulation &sim;
+  float radius;
+
+  /**
+   * @brief Shared brush per PassengerStore::State (COMPLETED is not drawn)
+   */
+  static const graphics::Brush &brushFor(PassengerStore::State state) {
+    static const graphics::Brush waitingBrush = [] {
+      graphics::Brush b;
+      b.fill_color[0] = 1.0f; // R
+      b.fill_color[1] = 0.2f; // G
+      b.fill_color[2] = 0.2f; // B
+      b.outline_opacity = 0.0f;
+      return b;
+    }();
+    static const graphics::Brush onTrainBrush = [] {
+      graphics::Brush b;
+      b.fill_color[0] = 1.0f; // R
+      b.fill_color[1] = 0.7f; // G
+      b.fill_color[2] = 0.1f; // B
+      b.outline_opacity = 1.0f;
+      return b;
+    }();
+    return state == PassengerStore::WAITING ? waitingBrush : onTrainBrush;
+  }
+
+  void drawState(PassengerStore::State wanted) {
+    const PassengerStore &store = sim.getPassengers();
+    const uint8_t *state = store.stateData();
+    const float *px = store.xData();
+    const float *py = store.yData();
+    const graphics::Brush &brush = brushFor(wanted);
+
+    for (size_t i = 0; i < store.size(); ++i) {
+      if (state[i] == wanted) {
+        graphics::drawDisk(px[i], py[i], radius, brush);
+      }
+    }
+  }
+
+public:
+  explicit PassengerLayer(Simulation &simulation, float r = 4.0f)
+      : VisualAsset(0.0f, 0.0f), sim(simulation), radius(r) {}
+
+  void update(int ms, const graphics::MouseState &mouse) override {
+    (void)ms;
+    (void)mouse;
+    // Logic handled by the Simulation, layout by Train/Station
+  }
+
+  void draw() override {
+    if (!active)
+      return;
+
+    // One sweep per brush so consecutive draws share state
+    drawState(PassengerStore::WAITING);
+    drawState(PassengerStore::ON_TRAIN); // Draw on train too
+  }
+};
+
+#endif // PASSENGER_LAYER_H
@@ -0,0 +1,198 @@
+#ifndef PASSENGER_STORE_H
+#define PASSENGER_STORE_H
+
+#include "Handle.h"
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+
+/**
+ * @brief Struct-of-arrays storage for every passenger in a simulation.
+ *
+ * A passenger is just an index into a handful of contiguous columns, which
+ * keeps the per-rider cost at kBytesPerPassenger bytes (no vtable, no
+ * brushes, no heap node) and lets sweeps over a single attribute stay in
+ * cache. Rendering state such as brushes is shared per State by the view
+ * layer instead of being stored per passenger.
+ *
+ * The store also keeps a live count of passengers in each State, updated on
+ * every add() and setState(), so "has everyone arrived?" is O(1).
+ *
+ * Finished riders are retire()d: their slot goes on a free list and is
+ * reused by the next add(), so the columns only grow to the peak number of
+ * riders in the system rather than the number ever spawned. Each slot has
+ * a generation that retire() bumps, so a Handle taken before the slot was
+ * reused is detected as stale.
+ */
+class PassengerStore {
+public:
+  /// FREE marks a retired slot waiting to be reused
+  enum State : uint8_t { WAITING, ON_TRAIN, COMPLETED, FREE };
+  static constexpr int kStateCount = 4;
+
+  /// Bytes of column storage used by one passenger
+  static constexpr size_t kBytesPerPassenger = sizeof(uint8_t) +
+                                               2 * sizeof(int32_t) +
+                                               2 * sizeof(float) +
+                                               sizeof(uint32_t) +
+                                               sizeof(uint64_t);
+
+private:
+  std::vector<uint8_t> state;
+  std::vector<int32_t> destination; // station id
+  std::vector<int32_t> location; // station id while WAITING, train id while
+                                 // ON_TRAIN, arrival station once COMPLETED
+  std::vector<float> posX;       // written by the view layer only
+  std::vector<float> posY;
+  std::vector<uint32_t> generation;
+  std::vector<uint64_t> waitingSince; // simulated ms the rider began waiting
+  std::vector<int32_t> freeSlots; // retired ids, reused last in first out
+  size_t stateCounts[kStateCount] = {0, 0, 0, 0};
+  size_t spawned = 0;
+  size_t retired = 0;
+
+public:
+  /**
+   * @brief Add a passenger, reusing a retired slot if there is one
+   * @return Id of the new passenger
+   */
+  int add(State s, int dest, int loc, float x, float y) {
+    int id;
+    if (!freeSlots.empty()) {
+      id = freeSlots.back();
+      freeSlots.pop_back();
+      stateCounts[FREE]--;
+      state[id] = s;
+      destination[id] = dest;
+      location[id] = loc;
+      posX[id] = x;
+      posY[id] = y;
+      waitingSince[id] = 0;
+    } else {
+      id = (int)state.size();
+      state.push_back(s);
+      destination.push_back(dest);
+      location.push_back(loc);
+      posX.push_back(x);
+      posY.push_back(y);
+      generation.push_back(0);
+      waitingSince.push_back(0);
+    }
+    stateCounts[s]++;
+    spawned++;
+    return id;
+  }
+
+  /**
+   * @brief Release a passenger's slot for reuse. The rider must no longer
+   * be queued at a station or seated on a train.
+   */
+  void retire(int id) {
+    if (state[id] == FREE)
+      return;
+    stateCounts[state[id]]--;
+    stateCounts[FREE]++;
+    state[id] = FREE;
+    generation[id]++;
+    freeSlots.push_back(id);
+    retired++;
+  }
+
+  /**
+   * @brief Handle to a live passenger, valid until it is retired
+   */
+  Handle handle(int id) const {
+    Handle h;
+    h.index = (uint32_t)id;
+    h.generation = generation[id];
+    return h;
+  }
+
+  /**
+   * @brief Whether a handle still refers to the passenger it was taken for
+   */
+  bool isValid(Handle h) const {
+    return h.index < state.size() && state[h.index] != FREE &&
+           generation[h.index] == h.generation;
+  }
+
+  void reserve(size_t n) {
+    state.reserve(n);
+    destination.reserve(n);
+    location.reserve(n);
+    posX.reserve(n);
+    posY.reserve(n);
+    generation.reserve(n);
+    waitingSince.reserve(n);
+  }
+
+  void clear() {
+    state.clear();
+    destination.clear();
+    location.clear();
+    posX.clear();
+    posY.clear();
+    generation.clear();
+    waitingSince.clear();
+    freeSlots.clear();
+    for (size_t &count : stateCounts)
+      count = 0;
+    spawned = retired = 0;
+  }
+
+  /// Number of slots, live or FREE; ids range over [0, size())
+  size_t size() const { return state.size(); }
+  bool empty() const { return state.empty(); }
+
+  /// Passengers ever added, and how many of those were retired
+  size_t getSpawnedCount() const { return spawned; }
+  size_t getRetiredCount() const { return retired; }
+
+  // Per-passenger access
+  State getState(int id) const { return (State)state[id]; }
+  void setState(int id, State s) {
+    stateCounts[state[id]]--;
+    stateCounts[s]++;
+    state[id] = s;
+  }
+
+  /**
+   * @brief setState() for concurrent callers: the change in per-state counts
+   * goes to countDelta instead of the shared counts, and is applied later
+   * with applyCountDelta()
+   */
+  void setState(int id, State s, long long countDelta[kStateCount]) {
+    countDelta[state[id]]--;
+    countDelta[s]++;
+    state[id] = s;
+  }
+  void applyCountDelta(const long long countDelta[kStateCount]) {
+    for (int i = 0; i < kStateCount; ++i)
+      stateCounts[i] = (size_t)((long long)stateCounts[i] + countDelta[i]);
+  }
+
+  /**
+   * @brief Number of passengers currently in the given state
+   */
+  size_t countIn(State s) const { return stateCounts[s]; }
+  int getDestination(int id) const { return destination[id]; }
+  int getLocation(int id) const { return location[id]; }
+  void setLocation(int id, int loc) { location[id] = loc; }
+  uint64_t getWaitingSince(int id) const { return waitingSince[id]; }
+  void setWaitingSince(int id, uint64_t ms) { waitingSince[id] = ms; }
+  float getX(int id) const { return posX[id]; }
+  float getY(int id) const { return posY[id]; }
+  void setPosition(int id, float x, float y) {
+    posX[id] = x;
+    posY[id] = y;
+  }
+
+  // Whole columns, for sweeps
+  const uint8_t *stateData() const { return state.data(); }
+  const int32_t *destinationData() const { return destination.data(); }
+  const int32_t *locationData() const { return location.data(); }
+  const float *xData() const { return posX.data(); }
+  const float *yData() const { return posY.data(); }
+};
+
+#endif // PASSENGER_STORE_H
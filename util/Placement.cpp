@@ -0,0 +1,154 @@
+#include "Placement.h"
+#include <algorithm>
+#include <cmath>
+
+namespace {
+
+/**
+ * @brief Background acceleration grid for Bridson sampling
+ *
+ * Sampled points are at least spacing apart, so they get a cell each, but
+ * fixed points may lie closer than that; a cell chains every point in it.
+ */
+class PoissonGrid {
+private:
+  float minX, minY, cell;
+  int cols, rows;
+  std::vector<int> cells;      // first point index in the cell, or -1
+  std::vector<int> nextInCell; // next point index in the same cell, or -1
+
+public:
+  PoissonGrid(float x0, float y0, float x1, float y1, float spacing)
+      : minX(x0), minY(y0), cell(spacing / std::sqrt(2.0f)) {
+    cols = (int)std::ceil((x1 - x0) / cell) + 1;
+    rows = (int)std::ceil((y1 - y0) / cell) + 1;
+    cells.assign((size_t)cols * rows, -1);
+  }
+
+  int colOf(float x) const { return (int)((x - minX) / cell); }
+  int rowOf(float y) const { return (int)((y - minY) / cell); }
+
+  bool contains(float x, float y) const {
+    int c = colOf(x), r = rowOf(y);
+    return x >= minX && y >= minY && c < cols && r < rows;
+  }
+
+  void add(const std::vector<PlacementPoint> &points, int index) {
+    const PlacementPoint &p = points[index];
+    if (!contains(p.x, p.y))
+      return;
+    if ((int)nextInCell.size() <= index)
+      nextInCell.resize(index + 1, -1);
+    int &head = cells[(size_t)rowOf(p.y) * cols + colOf(p.x)];
+    nextInCell[index] = head;
+    head = index;
+  }
+
+  /**
+   * @brief Whether (x, y) keeps its distance from every point in the grid.
+   * With cells of spacing/sqrt(2), any conflict lies within 2 cells.
+   */
+  bool isFree(const std::vector<PlacementPoint> &points, float x, float y,
+              float spacing) const {
+    int c0 = colOf(x), r0 = rowOf(y);
+    for (int r = r0 - 2; r <= r0 + 2; ++r) {
+      if (r < 0 || r >= rows)
+        continue;
+      for (int c = c0 - 2; c <= c0 + 2; ++c) {
+        if (c < 0 || c >= cols)
+          continue;
+        for (int i = cells[(size_t)r * cols + c]; i >= 0; i = nextInCell[i]) {
+          float dx = points[i].x - x;
+          float dy = points[i].y - y;
+          if (dx * dx + dy * dy < spacing * spacing)
+            return false;
+        }
+      }
+    }
+    return true;
+  }
+};
+
+} // namespace
+
+std::vector<PlacementPoint>
+poissonDiskPlacement(int count, float minX, float minY, float maxX, float maxY,
+                     float spacing, Rng &rng,
+                     const std::vector<PlacementPoint> &fixed) {
+  const int kCandidates = 30; // Bridson's k
+  const float kTwoPi = 6.28318530718f;
+
+  // points holds the fixed points first, then the ones we place
+  std::vector<PlacementPoint> points(fixed);
+  points.reserve(fixed.size() + count);
+  int placed = 0;
+
+  while (placed < count) {
+    // The grid also has to cover fixed points lying outside the area
+    float gx0 = minX, gy0 = minY, gx1 = maxX, gy1 = maxY;
+    for (const PlacementPoint &p : fixed) {
+      gx0 = std::min(gx0, p.x);
+      gy0 = std::min(gy0, p.y);
+      gx1 = std::max(gx1, p.x);
+      gy1 = std::max(gy1, p.y);
+    }
+    PoissonGrid grid(gx0, gy0, gx1, gy1, spacing);
+    std::vector<int> active;
+    for (int i = 0; i < (int)points.size(); ++i) {
+      grid.add(points, i);
+      active.push_back(i);
+    }
+
+    // Seed an empty area with one random point
+    if (points.empty()) {
+      points.push_back({minX + rng.nextFloat() * (maxX - minX),
+                        minY + rng.nextFloat() * (maxY - minY)});
+      grid.add(points, 0);
+      active.push_back(0);
+      placed++;
+    }
+
+    while (!active.empty() && placed < count) {
+      int slot = (int)rng.nextBelow((uint32_t)active.size());
+      PlacementPoint origin = points[active[slot]];
+
+      bool found = false;
+      for (int k = 0; k < kCandidates; ++k) {
+        // Uniform in the annulus [spacing, 2 * spacing) around origin
+        float angle = rng.nextFloat() * kTwoPi;
+        float dist = spacing * (1.0f + rng.nextFloat());
+        float x = origin.x + std::cos(angle) * dist;
+        float y = origin.y + std::sin(angle) * dist;
+        if (x < minX || x > maxX || y < minY || y > maxY)
+          continue;
+        if (!grid.isFree(points, x, y, spacing))
+          continue;
+
+        points.push_back({x, y});
+        grid.add(points, (int)points.size() - 1);
+        active.push_back((int)points.size() - 1);
+        placed++;
+        found = true;
+        break;
+      }
+
+      if (!found) {
+        active[slot] = active.back();
+        active.pop_back();
+      }
+    }
+
+    if (placed < count) {
+      // Area is full: grow it around its centre and keep sampling
+      float growX = (maxX - minX) * 0.25f + spacing;
+      float growY = (maxY - minY) * 0.25f + spacing;
+      minX -= growX;
+      maxX += growX;
+      minY -= growY;
+      maxY += growY;
+    }
+  }
+
+  return std::vector<PlacementPoint>(points.begin() + fixed.size(),
+                                     points.end());
+}
@@ -0,0 +1,41 @@
+#ifndef PLACEMENT_H
+#define PLACEMENT_H
+
+#include "Rng.h"
+#include <vector>
+
+/**
+ * @brief A 2D position produced by station placement
+ */
+struct PlacementPoint {
+  float x;
+  float y;
+};
+
+/**
+ * @brief Place points with a guaranteed minimum spacing (Bridson's
+ * Poisson-disk sampling)
+ * @param count Number of new points wanted
+ * @param minX Left edge of the placement area
+ * @param minY Top edge of the placement area
+ * @param maxX Right edge of the placement area
+ * @param maxY Bottom edge of the placement area
+ * @param spacing Minimum distance between any two points
+ * @param rng Random stream to draw from
+ * @param fixed Points that already exist (e.g. stations with explicit
+ * coordinates); new points keep their distance from these too
+ * @return Exactly count new points
+ *
+ * A background grid with cells of spacing/sqrt(2) holds at most one placed
+ * point per cell (fixed points closer than spacing share a cell), so every
+ * candidate is checked against a constant number of neighbours and
+ * placement is linear in the number of points. If the area
+ * fills up before count points are placed it is enlarged around its centre
+ * and sampling continues, so spacing is never traded for fitting in.
+ */
+std::vector<PlacementPoint>
+poissonDiskPlacement(int count, float minX, float minY, float maxX, float maxY,
+                     float spacing, Rng &rng,
+                     const std::vector<PlacementPoint> &fixed = {});
+
+#endif // PLACEMENT_H
@@ -0,0 +1,145 @@
+#ifndef POOL_H
+#define POOL_H
+
+#include "Handle.h"
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+#include <new>
+#include <utility>
+#include <vector>
+
+/**
+ * @brief Typed object pool with a free list and generational handles.
+ *
+ * Objects are constructed in place in fixed-size blocks, so their
+ * addresses never change and raw pointers stay valid until the object is
+ * destroyed. Released slots go on a free list and are reused first, which
+ * makes create() and destroy() O(1) and, once the pool has grown to its
+ * working size, allocation-free.
+ */
+template <typename T> class Pool {
+private:
+  static constexpr uint32_t kBlockSize = 64;
+
+  struct Slot {
+    alignas(T) unsigned char storage[sizeof(T)];
+    uint32_t generation = 0;
+    bool live = false;
+
+    T *object() { return reinterpret_cast<T *>(storage); }
+  };
+
+  std::vector<std::unique_ptr<Slot[]>> blocks;
+  std::vector<uint32_t> freeList;
+  uint32_t slotCount = 0;
+  size_t liveCount = 0;
+
+  Slot &slot(uint32_t index) {
+    return blocks[index / kBlockSize][index % kBlockSize];
+  }
+  const Slot &slot(uint32_t index) const {
+    return blocks[index / kBlockSize][index % kBlockSize];
+  }
+
+public:
+  Pool() = default;
+  Pool(const Pool &) = delete;
+  Pool &operator=(const Pool &) = delete;
+  ~Pool() { clear(); }
+
+  /**
+   * @brief Construct an object in a free slot
+   */
+  template <typename... Args> Handle create(Args &&...args) {
+    uint32_t index;
+    if (!freeList.empty()) {
+      index = freeList.back();
+      freeList.pop_back();
+    } else {
+      if (slotCount % kBlockSize == 0)
+        blocks.emplace_back(new Slot[kBlockSize]);
+      index = slotCount++;
+    }
+
+    Slot &s = slot(index);
+    try {
+      new (s.storage) T(std::forward<Args>(args)...);
+    } catch (...) {
+      freeList.push_back(index);
+      throw;
+    }
+    s.live = true;
+    liveCount++;
+
+    Handle handle;
+    handle.index = index;
+    handle.generation = s.generation;
+    return handle;
+  }
+
+  /**
+   * @brief The object a handle refers to, or nullptr if it is stale
+   */
+  T *get(Handle handle) {
+    if (handle.index >= slotCount)
+      return nullptr;
+    Slot &s = slot(handle.index);
+    return s.live && s.generation == handle.generation ? s.object() : nullptr;
+  }
+
+  bool isValid(Handle handle) const {
+    if (handle.index >= slotCount)
+      return false;
+    const Slot &s = slot(handle.index);
+    return s.live && s.generation == handle.generation;
+  }
+
+  /**
+   * @brief Destroy the object and recycle its slot
+   * @return false if the handle was already stale
+   */
+  bool destroy(Handle handle) {
+    T *object = get(handle);
+    if (!object)
+      return false;
+    object->~T();
+    Slot &s = slot(handle.index);
+    s.live = false;
+    s.generation++;
+    freeList.push_back(handle.index);
+    liveCount--;
+    return true;
+  }
+
+  /**
+   * @brief Visit every live object
+   */
+  template <typename F> void forEach(F f) {
+    for (uint32_t i = 0; i < slotCount; ++i) {
+      Slot &s = slot(i);
+      if (s.live)
+        f(*s.object());
+    }
+  }
+
+  /**
+   * @brief Destroy every live object
+   */
+  void clear() {
+    for (uint32_t i = 0; i < slotCount; ++i) {
+      Slot &s = slot(i);
+      if (s.live) {
+        s.object()->~T();
+        s.live = false;
+        s.generation++;
+        freeList.push_back(i);
+      }
+    }
+    liveCount = 0;
+  }
+
+  size_t size() const { return liveCount; }
+};
+
+#endif // POOL_H
@@ -0,0 +1,106 @@
+#include "Profiler.h"
+#include <algorithm>
+#include <cstdio>
+#include <fstream>
+
+namespace {
+// The calling thread's buffer, created on its first event, and the name it
+// should carry
+thread_local void *threadBuffer = nullptr;
+thread_local std::string threadName;
+} // namespace
+
+Profiler::ThreadBuffer &Profiler::local() {
+  if (!threadBuffer) {
+    std::lock_guard<std::mutex> lock(registry);
+    buffers.emplace_back(new ThreadBuffer());
+    ThreadBuffer &buffer = *buffers.back();
+    buffer.tid = (int)buffers.size();
+    buffer.name = threadName.empty() ? "thread " + std::to_string(buffer.tid)
+                                     : threadName;
+    buffer.events.resize(kEventsPerThread);
+    buffer.written = 0;
+    threadBuffer = &buffer;
+  }
+  return *static_cast<ThreadBuffer *>(threadBuffer);
+}
+
+void Profiler::record(const char *name, uint64_t startNs, uint64_t endNs) {
+  ThreadBuffer &buffer = local();
+  Event &event = buffer.events[buffer.written % kEventsPerThread];
+  event.name = name;
+  event.startNs = startNs;
+  event.durationNs = endNs - startNs;
+  buffer.written++;
+}
+
+void Profiler::setThreadName(const std::string &name) {
+  threadName = name;
+  if (threadBuffer) {
+    std::lock_guard<std::mutex> lock(registry);
+    static_cast<ThreadBuffer *>(threadBuffer)->name = name;
+  }
+}
+
+void Profiler::clear() {
+  std::lock_guard<std::mutex> lock(registry);
+  for (auto &buffer : buffers)
+    buffer->written = 0;
+}
+
+static void writeJsonString(std::ostream &out, const std::string &s) {
+  out << '"';
+  for (char c : s) {
+    if (c == '"' || c == '\\')
+      out << '\\' << c;
+    else if ((unsigned char)c < 0x20)
+      out << ' ';
+    else
+      out << c;
+  }
+  out << '"';
+}
+
+bool Profiler::writeChromeTrace(const std::string &path) {
+  std::ofstream out(path);
+  if (!out)
+    return false;
+
+  std::lock_guard<std::mutex> lock(registry);
+  out << "{\"displayTimeUnit\": \"ms\", \"traceEvents\": [";
+  bool first = true;
+  char number[64];
+  for (const auto &buffer : buffers) {
+    out << (first ? "\n" : ",\n")
+        << "{\"ph\": \"M\", \"name\": \"thread_name\", \"pid\": 1, \"tid\": "
+        << buffer->tid << ", \"args\": {\"name\": ";
+    writeJsonString(out, buffer->name);
+    out << "}}";
+    first = false;
+
+    // Oldest surviving event first
+    uint64_t count = std::min<uint64_t>(buffer->written, kEventsPerThread);
+    for (uint64_t i = buffer->written - count; i < buffer->written; ++i) {
+      const Event &event = buffer->events[i % kEventsPerThread];
+      std::snprintf(number, sizeof(number), "%.3f, \"dur\": %.3f",
+                    event.startNs / 1000.0, event.durationNs / 1000.0);
+      out << ",\n{\"ph\": \"X\", \"name\": ";
+      writeJsonString(out, event.name);
+      out << ", \"pid\": 1, \"tid\": " << buffer->tid << ", \"ts\": " << number
+          << "}";
+    }
+  }
+  out << "\n]}\n";
+  return (bool)out;
+}
+
+float FrameStats::percentile(float p) const {
+  if (count == 0)
+    return 0.0f;
+  scratch.assign(samples.begin(), samples.begin() + count);
+  size_t rank = (size_t)(p / 100.0f * (float)(count - 1) + 0.5f);
+  if (rank >= count)
+    rank = count - 1;
+  std::nth_element(scratch.begin(), scratch.begin() + rank, scratch.end());
+  return scratch[rank];
+}
@@ -0,0 +1,148 @@
+#ifndef PROFILER_H
+#define PROFILER_H
+
+#include <atomic>
+#include <chrono>
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <vector>
+
+/**
+ * @brief Process-wide scoped-timer profiler.
+ *
+ * Each thread records into its own fixed-size ring buffer, so recording
+ * takes no lock and never allocates once the buffer exists; when a buffer
+ * is full the oldest events are overwritten. While the profiler is
+ * disabled (the default) a ProfileScope costs one relaxed atomic load.
+ *
+ * The recorded events can be written as Chrome trace-event JSON, viewable
+ * in chrome://tracing or https://ui.perfetto.dev, with one track per
+ * thread.
+ */
+class Profiler {
+public:
+  struct Event {
+    const char *name; // must outlive the profiler, e.g. a string literal
+    uint64_t startNs;
+    uint64_t durationNs;
+  };
+
+  /// Events kept per thread before the oldest are overwritten
+  static constexpr size_t kEventsPerThread = 1 << 18;
+
+  static void setEnabled(bool on) {
+    enabled.store(on, std::memory_order_relaxed);
+  }
+  static bool isEnabled() { return enabled.load(std::memory_order_relaxed); }
+
+  /// Nanoseconds since the profiler's epoch
+  static uint64_t nowNs() {
+    return (uint64_t)std::chrono::duration_cast<std::chrono::nanoseconds>(
+               std::chrono::steady_clock::now() - epoch)
+        .count();
+  }
+
+  /**
+   * @brief Record a finished event on the calling thread
+   */
+  static void record(const char *name, uint64_t startNs, uint64_t endNs);
+
+  /**
+   * @brief Name the calling thread's track in the trace (cheap; does not
+   * create the thread's buffer)
+   */
+  static void setThreadName(const std::string &name);
+
+  /**
+   * @brief Write every recorded event as Chrome trace-event JSON
+   * @return false if the file could not be written
+   * @note Call while no other thread is recording, e.g. between ticks
+   */
+  static bool writeChromeTrace(const std::string &path);
+
+  /**
+   * @brief Drop every recorded event (buffers are kept for reuse)
+   */
+  static void clear();
+
+private:
+  struct ThreadBuffer {
+    int tid;
+    std::string name;
+    std::vector<Event> events; // ring, kEventsPerThread long
+    uint64_t written;          // events ever recorded
+  };
+
+  static ThreadBuffer &local();
+
+  static inline std::atomic<bool> enabled{false};
+  static inline const std::chrono::steady_clock::time_point epoch =
+      std::chrono::steady_clock::now();
+  static inline std::mutex registry;
+  static inline std::vector<std::unique_ptr<ThreadBuffer>> buffers;
+};
+
+/**
+ * @brief Times the enclosing scope under a name while profiling is on
+ *
+ *   void Simulation::step(int ms) {
+ *     ProfileScope scope("tick");
+ *     ...
+ */
+class ProfileScope {
+private:
+  const char *name;
+  uint64_t start;
+  bool active;
+
+public:
+  explicit ProfileScope(const char *eventName)
+      : name(eventName), start(0), active(Profiler::isEnabled()) {
+    if (active)
+      start = Profiler::nowNs();
+  }
+  ~ProfileScope() {
+    if (active)
+      Profiler::record(name, start, Profiler::nowNs());
+  }
+
+  ProfileScope(const ProfileScope &) = delete;
+  ProfileScope &operator=(const ProfileScope &) = delete;
+};
+
+/**
+ * @brief Rolling window of frame times with percentiles
+ */
+class FrameStats {
+private:
+  std::vector<float> samples; // ring
+  size_t next;
+  size_t count;
+  mutable std::vector<float> scratch;
+
+public:
+  explicit FrameStats(size_t window = 240)
+      : samples(window, 0.0f), next(0), count(0) {
+    scratch.reserve(window);
+  }
+
+  void add(float ms) {
+    samples[next] = ms;
+    next = (next + 1) % samples.size();
+    if (count < samples.size())
+      count++;
+  }
+
+  /**
+   * @brief The p-th percentile (0..100) of the window, 0 if it is empty
+   */
+  float percentile(float p) const;
+
+  size_t size() const { return count; }
+  void clear() { next = count = 0; }
+};
+
+#endif // PROFILER_H
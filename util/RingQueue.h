@@ -0,0 +1,65 @@
+#ifndef RING_QUEUE_H
+#define RING_QUEUE_H
+
+#include <cstddef>
+#include <vector>
+
+/**
+ * @brief FIFO queue over a power-of-two ring buffer.
+ *
+ * push_back() and pop_front() are O(1) and only allocate when the queue
+ * outgrows its current capacity, so a queue that has reached its working
+ * size never allocates again. Elements can also be read by position, front
+ * first, which the view layer uses to lay riders out.
+ */
+template <typename T> class RingQueue {
+private:
+  std::vector<T> buffer;
+  size_t head;  // index of the front element
+  size_t count; // number of queued elements
+
+  void grow() {
+    size_t newCapacity = buffer.empty() ? 8 : buffer.size() * 2;
+    std::vector<T> bigger(newCapacity);
+    for (size_t i = 0; i < count; ++i)
+      bigger[i] = (*this)[i];
+    buffer.swap(bigger);
+    head = 0;
+  }
+
+public:
+  RingQueue() : head(0), count(0) {}
+
+  void push_back(const T &value) {
+    if (count == buffer.size())
+      grow();
+    buffer[(head + count) & (buffer.size() - 1)] = value;
+    count++;
+  }
+
+  /**
+   * @brief Remove and return the front element. The queue must not be empty.
+   */
+  T pop_front() {
+    T value = buffer[head];
+    head = (head + 1) & (buffer.size() - 1);
+    count--;
+    return value;
+  }
+
+  const T &front() const { return buffer[head]; }
+  const T &operator[](size_t i) const {
+    return buffer[(head + i) & (buffer.size() - 1)];
+  }
+
+  size_t size() const { return count; }
+  bool empty() const { return count == 0; }
+  size_t capacity() const { return buffer.size(); }
+
+  void clear() {
+    head = 0;
+    count = 0;
+  }
+};
+
+#endif // RING_QUEUE_H
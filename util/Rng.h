@@ -0,0 +1,91 @@
+#ifndef RNG_H
+#define RNG_H
+
+#include <cstdint>
+
+/**
+ * @brief Small, fast, reproducible random number stream (PCG32).
+ *
+ * Unlike std::rand() or the std::*_distribution helpers, the output of an
+ * Rng depends only on its seed and stream id, so the same seed reproduces a
+ * run bit-for-bit on every platform. Each entity that needs randomness owns
+ * its own stream, which keeps results independent of update order.
+ */
+class Rng {
+private:
+  uint64_t state;
+  uint64_t inc;
+
+public:
+  /**
+   * @brief Domains used to derive independent streams from one run seed
+   */
+  enum Domain : uint64_t {
+    PLACEMENT = 1, // station placement when loading
+    SCENARIO = 2,  // initial fleet and riders
+    TRAIN = 3,     // per-train dispatch decisions (index = train id)
+    DEMAND = 4,    // passenger arrivals
+  };
+
+  explicit Rng(uint64_t seed = 0, uint64_t stream = 0)
+      : state(0), inc((stream << 1u) | 1u) {
+    next();
+    state += seed;
+    next();
+  }
+
+  /**
+   * @brief Create the stream for one entity of a domain
+   * @param seed Run seed
+   * @param domain What the stream is used for
+   * @param index Entity id within the domain
+   */
+  static Rng forEntity(uint64_t seed, Domain domain, uint64_t index = 0) {
+    return Rng(seed, ((uint64_t)domain << 32) | (index & 0xffffffffu));
+  }
+
+  uint32_t next() {
+    uint64_t old = state;
+    state = old * 6364136223846793005ULL + inc;
+    uint32_t xorshifted = (uint32_t)(((old >> 18u) ^ old) >> 27u);
+    uint32_t rot = (uint32_t)(old >> 59u);
+    return (xorshifted >> rot) | (xorshifted << ((-rot) & 31));
+  }
+
+  /**
+   * @brief Uniform integer in [0, bound) without modulo bias
+   */
+  uint32_t nextBelow(uint32_t bound) {
+    if (bound == 0)
+      return 0;
+    uint32_t threshold = (0u - bound) % bound;
+    for (;;) {
+      uint32_t r = next();
+      if (r >= threshold)
+        return r % bound;
+    }
+  }
+
+  /**
+   * @brief Uniform integer in [lo, hi]
+   */
+  int nextInt(int lo, int hi) {
+    return lo + (int)nextBelow((uint32_t)(hi - lo + 1));
+  }
+
+  /**
+   * @brief Uniform float in [0, 1)
+   */
+  float nextFloat() { return (next() >> 8) * (1.0f / 16777216.0f); }
+
+  /**
+   * @brief Uniform double in [0, 1)
+   */
+  double nextDouble() {
+    uint64_t hi = next() >> 5;
+    uint64_t lo = next() >> 6;
+    return (hi * 67108864.0 + lo) * (1.0 / 9007199254740992.0);
+  }
+};
+
+#endif // RNG_H
@@ -0,0 +1,115 @@
+#include "Routing.h"
+#include "Simulation.h"
+#include <algorithm>
+
+void RoutingTable::clear() {
+  for (int to : cached)
+    delete columns[to].load(std::memory_order_relaxed);
+  cached.clear();
+  columns.reset();
+  stationCount = 0;
+  revStart.clear();
+  revFrom.clear();
+  revSlot.clear();
+  queue.clear();
+}
+
+void RoutingTable::build(const std::vector<SimStation> &stations) {
+  clear();
+  stationCount = (int)stations.size();
+  columns.reset(new std::atomic<Column *>[stationCount]);
+  for (int i = 0; i < stationCount; ++i)
+    columns[i].store(nullptr, std::memory_order_relaxed);
+
+  // Only the connections that get a slot are indexed, so every entry below
+  // is filled in
+  auto routed = [](const SimStation &station) {
+    return std::min((int)station.next.size(), kMaxConnections);
+  };
+  revStart.assign(stationCount + 1, 0);
+  for (int u = 0; u < stationCount; ++u) {
+    for (int k = 0; k < routed(stations[u]); ++k)
+      revStart[stations[u].next[k] + 1]++;
+  }
+  for (int v = 0; v < stationCount; ++v)
+    revStart[v + 1] += revStart[v];
+
+  revFrom.resize(revStart[stationCount]);
+  revSlot.resize(revStart[stationCount]);
+  std::vector<int> fill(revStart.begin(), revStart.end() - 1);
+  for (int u = 0; u < stationCount; ++u) {
+    const std::vector<int> &next = stations[u].next;
+    for (int k = 0; k < routed(stations[u]); ++k) {
+      int at = fill[next[k]]++;
+      revFrom[at] = u;
+      revSlot[at] = (uint8_t)k;
+    }
+  }
+}
+
+const RoutingTable::Column *RoutingTable::buildColumn(int to) const {
+  std::lock_guard<std::mutex> lock(buildMutex);
+  Column *column = columns[to].load(std::memory_order_acquire);
+  if (column)
+    return column; // another thread got here first
+
+  column = new Column();
+  column->used.store(false, std::memory_order_relaxed);
+  column->slots.assign(stationCount, kNoRoute);
+
+  // BFS backwards from the destination. The first time a station u is
+  // reached through edge u -> v, that edge starts a shortest route to it.
+  queue.resize(stationCount);
+  int head = 0, tail = 0;
+  queue[tail++] = to;
+  while (head < tail) {
+    int v = queue[head++];
+    for (int e = revStart[v]; e < revStart[v + 1]; ++e) {
+      int u = revFrom[e];
+      if (u == to || column->slots[u] != kNoRoute)
+        continue;
+      column->slots[u] = revSlot[e];
+      queue[tail++] = u;
+    }
+  }
+
+  cached.push_back(to);
+  columns[to].store(column, std::memory_order_release);
+  return column;
+}
+
+void RoutingTable::trim() {
+  size_t columnBytes = (size_t)stationCount;
+  if (cached.size() * columnBytes <= cacheBudget)
+    return;
+
+  // Second chance: keep the columns used since the last trim, then drop
+  // the oldest of those if that is still not enough
+  size_t keep = 0;
+  for (int to : cached) {
+    Column *column = columns[to].load(std::memory_order_relaxed);
+    if (column->used.load(std::memory_order_relaxed)) {
+      column->used.store(false, std::memory_order_relaxed);
+      cached[keep++] = to;
+    } else {
+      delete column;
+      columns[to].store(nullptr, std::memory_order_relaxed);
+    }
+  }
+  cached.resize(keep);
+
+  size_t excess = 0;
+  while (excess < cached.size() &&
+         (cached.size() - excess) * columnBytes > cacheBudget) {
+    delete columns[cached[excess]].load(std::memory_order_relaxed);
+    columns[cached[excess]].store(nullptr, std::memory_order_relaxed);
+    excess++;
+  }
+  cached.erase(cached.begin(), cached.begin() + excess);
+}
+
+size_t RoutingTable::memoryBytes() const {
+  return revStart.size() * sizeof(int) + revFrom.size() * sizeof(int) +
+         revSlot.size() + (size_t)stationCount * sizeof(Column *) +
+         cached.size() * (sizeof(Column) + (size_t)stationCount);
+}
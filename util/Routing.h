@@ -0,0 +1,114 @@
+#ifndef ROUTING_H
+#define ROUTING_H
+
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+#include <mutex>
+#include <vector>
+
+struct SimStation;
+
+/**
+ * @brief Next-hop routes over the station graph, computed per destination
+ * on first use and cached.
+ *
+ * build() only indexes the Station::next connections backwards, in O(E).
+ * The first lookup towards a destination runs one breadth-first search
+ * backwards from it and keeps the result as a column: for every station,
+ * the first leg of a shortest (fewest stops) route there. Hop count rather
+ * than track length is used on purpose: stations can be dragged at any
+ * time, but the topology only changes when the network is loaded.
+ *
+ * A column stores the index of the hop within the source station's next
+ * list, one byte per station, so only the destinations riders actually
+ * head for cost memory, N bytes each. When the columns exceed the cache
+ * budget, trim() drops the ones not used since the last trim; a dropped
+ * column is recomputed, identically, when it is needed again.
+ *
+ * Lookups are safe from several threads at once. Columns are only ever
+ * added while they run, so trim() and build() must not overlap with them.
+ */
+class RoutingTable {
+public:
+  /// Marks "no route" (or from == to) in a column
+  static constexpr uint8_t kNoRoute = 0xFF;
+  /// Most connections a station can have, so that every slot fits a byte
+  static constexpr int kMaxConnections = 254;
+  static constexpr size_t kDefaultCacheBytes = (size_t)256 << 20;
+
+private:
+  struct Column {
+    std::atomic<bool> used;     // looked up since the last trim()
+    std::vector<uint8_t> slots; // [from]
+  };
+
+  int stationCount;
+  // Reverse connections: for every station v, the (u, slot) pairs with
+  // stations[u].next[slot] == v, in revFrom/revSlot[revStart[v] ..
+  // revStart[v + 1])
+  std::vector<int> revStart;
+  std::vector<int> revFrom;
+  std::vector<uint8_t> revSlot;
+
+  // columns[to] is published once computed; the mutex serializes builders
+  std::unique_ptr<std::atomic<Column *>[]> columns;
+  mutable std::mutex buildMutex;
+  mutable std::vector<int> cached; // destinations that have a column
+  mutable std::vector<int> queue;  // BFS scratch, used under buildMutex
+  size_t cacheBudget;
+
+  const Column *buildColumn(int to) const;
+
+public:
+  RoutingTable() : stationCount(0), cacheBudget(kDefaultCacheBytes) {}
+  ~RoutingTable() { clear(); }
+  RoutingTable(const RoutingTable &) = delete;
+  RoutingTable &operator=(const RoutingTable &) = delete;
+
+  /**
+   * @brief Index the connections of the given stations and forget every
+   * cached column
+   * @note Connections past the first kMaxConnections of a station are not
+   * routed over; Simulation::connect() never makes them
+   */
+  void build(const std::vector<SimStation> &stations);
+
+  /// Drop the index and every column
+  void clear();
+
+  /**
+   * @brief Index of the first hop within stations[from].next, or kNoRoute
+   * if from == to or the destination is unreachable
+   */
+  uint8_t nextHopSlot(int from, int to) const {
+    const Column *column = columns[to].load(std::memory_order_acquire);
+    if (!column)
+      column = buildColumn(to);
+    // Read first, so hot columns are not written to on every lookup
+    if (!column->used.load(std::memory_order_relaxed))
+      const_cast<Column *>(column)->used.store(true,
+                                               std::memory_order_relaxed);
+    return column->slots[from];
+  }
+
+  bool isReachable(int from, int to) const {
+    return from == to || nextHopSlot(from, to) != kNoRoute;
+  }
+
+  /**
+   * @brief Drop columns not used since the last call while the cache is
+   * over budget. Call between ticks, when no lookup is running.
+   */
+  void trim();
+
+  /// Bytes of cached columns trim() keeps to (a single column may exceed it)
+  void setCacheBudget(size_t bytes) { cacheBudget = bytes; }
+
+  int size() const { return stationCount; }
+  size_t getCachedColumns() const { return cached.size(); }
+  size_t memoryBytes() const;
+};
+
+#endif // ROUTING_H
@@ -0,0 +1,97 @@
+#include "Scenario.h"
+#include "CommandLine.h"
+#include <cmath>
+#include <cstdlib>
+#include <stdexcept>
+#include <vector>
+
+void setupScenario(Simulation &sim, int trains, int riders) {
+  int stationCount = (int)sim.getStations().size();
+  if (stationCount == 0)
+    return;
+
+  Rng rng = sim.makeRng(Rng::SCENARIO);
+
+  // Distinct start stations while there are free ones left
+  std::vector<uint8_t> used(stationCount, 0);
+  for (int i = 0; i < trains; ++i) {
+    int startIdx = (int)rng.nextBelow(stationCount);
+    if (i < stationCount) {
+      while (used[startIdx])
+        startIdx = (int)rng.nextBelow(stationCount);
+      used[startIdx] = 1;
+    }
+    sim.addTrain(startIdx);
+  }
+
+  // Spawn passengers with random destinations
+  for (int i = 0; i < riders; ++i) {
+    int startIdx = (int)rng.nextBelow(stationCount);
+    int endIdx = (int)rng.nextBelow(stationCount);
+
+    // Ensure dest != start ideally, and make sure not more than 6 passengers
+    // spawn in the same station
+    while (startIdx == endIdx && stationCount > 1) {
+      endIdx = (int)rng.nextBelow(stationCount);
+    }
+
+    // Skip riders who could never get there
+    if (!sim.getRoutes().isReachable(startIdx, endIdx))
+      continue;
+
+    if (sim.getStation(startIdx).waitingCount <= 6) {
+      sim.addPassenger(startIdx, endIdx);
+    }
+  }
+}
+
+void setupDemoScenario(Simulation &sim) { setupScenario(sim, 3, 20); }
+
+DemandOptions getDemandArgs(int argc, char *argv[], double defaultRate) {
+  DemandOptions options;
+  options.ridersPerHour = std::atof(
+      getArgValue(argc, argv, "--demand", std::to_string(defaultRate))
+          .c_str());
+  options.profile = getArgValue(argc, argv, "--demand-profile", "flat");
+  options.flowsPath = getArgValue(argc, argv, "--demand-flows");
+  // Any finite hour is taken modulo a day, so -5 means 19:00
+  options.startHour =
+      std::atof(getArgValue(argc, argv, "--start-hour", "7").c_str());
+  if (std::isfinite(options.startHour)) {
+    options.startHour = std::fmod(options.startHour, 24.0);
+    if (options.startHour < 0.0)
+      options.startHour += 24.0;
+  }
+  options.minutes =
+      std::atof(getArgValue(argc, argv, "--demand-minutes", "-1").c_str());
+  return options;
+}
+
+void setupDemand(Simulation &sim, const DemandOptions &options) {
+  int stationCount = (int)sim.getStations().size();
+  if (stationCount < 2 ||
+      (options.ridersPerHour <= 0.0 && options.flowsPath.empty()))
+    return;
+
+  if (!std::isfinite(options.startHour))
+    throw std::runtime_error("Start hour must be a number");
+
+  DemandProfile profile;
+  if (!DemandProfile::byName(options.profile, profile))
+    throw std::runtime_error("Unknown demand profile '" + options.profile +
+                             "'");
+
+  DemandModel model(stationCount);
+  model.setBackgroundRate(options.ridersPerHour);
+  model.setProfile(profile);
+  if (!options.flowsPath.empty())
+    model.loadFlows(sim, options.flowsPath);
+
+  long long startOfDayMs = (long long)(options.startHour * 60 * 60 * 1000);
+  std::unique_ptr<DemandGenerator> generator(
+      new DemandGenerator(model, sim.makeRng(Rng::DEMAND), startOfDayMs));
+  if (options.minutes >= 0.0)
+    generator->setEndMs(sim.getElapsedMs() +
+                        (long long)(options.minutes * 60 * 1000));
+  sim.setDemand(std::move(generator));
+}
@@ -0,0 +1,56 @@
+#ifndef SCENARIO_H
+#define SCENARIO_H
+
+#include "Simulation.h"
+#include <string>
+
+/**
+ * @brief Spawn a fleet and riders on an already loaded network
+ * @param sim Simulation with stations and connections in place
+ * @param trains Fleet size
+ * @param riders Passengers to try to spawn
+ *
+ * Places the trains on distinct random stations (reusing stations once
+ * every one has a train) and spawns riders with random destinations,
+ * skipping stations that already have more than 6 riders waiting and
+ * destinations with no route from the origin. Routes must already be built
+ * (see Simulation::buildRoutes()).
+ */
+void setupScenario(Simulation &sim, int trains, int riders);
+
+/**
+ * @brief The demo: setupScenario() with 3 trains and 20 riders
+ */
+void setupDemoScenario(Simulation &sim);
+
+/**
+ * @brief Settings for continuous passenger demand
+ */
+struct DemandOptions {
+  double ridersPerHour = 0.0; // background rate per station; 0 turns it off
+  std::string profile = "flat";
+  std::string flowsPath;      // optional OD flows CSV, see loadFlows()
+  double startHour = 7.0;     // time of day at simulated time 0
+  double minutes = -1.0;      // stop generating after this long; -1 never
+};
+
+/**
+ * @brief Read DemandOptions from "--demand=", "--demand-profile=",
+ * "--demand-flows=", "--start-hour=" and "--demand-minutes="
+ *
+ * The start hour is wrapped into [0, 24); a value that is not a number is
+ * kept, and rejected by setupDemand().
+ * @param defaultRate Background rate used when --demand is absent
+ */
+DemandOptions getDemandArgs(int argc, char *argv[], double defaultRate);
+
+/**
+ * @brief Attach a demand generator to a loaded network
+ *
+ * Does nothing if the options give no demand at all.
+ * @throws std::runtime_error on an unknown profile, a start hour that is
+ * not a number or a bad flows file
+ */
+void setupDemand(Simulation &sim, const DemandOptions &options);
+
+#endif // SCENARIO_H
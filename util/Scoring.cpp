@@ -0,0 +1,77 @@
+#include "Scoring.h"
+#include "Simulation.h"
+#include <climits>
+
+ScoreKeeper::ScoreKeeper() : score(0) { setRules(defaultRules()); }
+
+const std::vector<ScoreRule> &ScoreKeeper::defaultRules() {
+  static const std::vector<ScoreRule> table = {
+      {"delivery", ScoreRule::DELIVERY, 10, 0, 0},
+      {"time", ScoreRule::ELAPSED, -2, 10000, 0},
+      {"crowding", ScoreRule::CROWDING, -1, 10000, 6},
+  };
+  return table;
+}
+
+void ScoreKeeper::setRules(const std::vector<ScoreRule> &table) {
+  rules = table;
+  reset();
+}
+
+void ScoreKeeper::reset() {
+  score = 0;
+  nextDueMs.assign(rules.size(), 0);
+  totals.assign(rules.size(), 0);
+  for (size_t i = 0; i < rules.size(); ++i)
+    nextDueMs[i] = rules[i].periodMs;
+}
+
+void ScoreKeeper::apply(size_t rule, int points) {
+  // Penalties stop at zero, as the score never goes negative
+  if (points < 0 && score + points < 0)
+    points = -score;
+  score += points;
+  totals[rule] += points;
+}
+
+void ScoreKeeper::onDeliveries(int count) {
+  if (count <= 0)
+    return;
+  for (size_t i = 0; i < rules.size(); ++i) {
+    if (rules[i].event == ScoreRule::DELIVERY)
+      apply(i, rules[i].points * count);
+  }
+}
+
+void ScoreKeeper::onTick(long long elapsedMs,
+                         const std::vector<SimStation> &stations) {
+  for (size_t i = 0; i < rules.size(); ++i) {
+    const ScoreRule &rule = rules[i];
+    if (rule.event == ScoreRule::DELIVERY || rule.periodMs <= 0)
+      continue;
+
+    while (elapsedMs >= nextDueMs[i]) {
+      nextDueMs[i] += rule.periodMs;
+      if (rule.event == ScoreRule::ELAPSED) {
+        apply(i, rule.points);
+      } else {
+        int crowded = 0;
+        for (const SimStation &station : stations) {
+          if (station.waitingCount > rule.threshold)
+            crowded++;
+        }
+        apply(i, rule.points * crowded);
+      }
+    }
+  }
+}
+
+long long ScoreKeeper::getNextDueMs() const {
+  long long next = LLONG_MAX;
+  for (size_t i = 0; i < rules.size(); ++i) {
+    if (rules[i].event != ScoreRule::DELIVERY && rules[i].periodMs > 0 &&
+        nextDueMs[i] < next)
+      next = nextDueMs[i];
+  }
+  return next;
+}
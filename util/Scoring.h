@@ -0,0 +1,89 @@
+#ifndef SCORING_H
+#define SCORING_H
+
+#include <string>
+#include <vector>
+
+struct SimStation;
+
+/**
+ * @brief One line of the score rule table.
+ *
+ * DELIVERY rules fire once per passenger who reaches their destination.
+ * ELAPSED rules fire every periodMs of simulated time. CROWDING rules fire
+ * every periodMs for each station with more than threshold waiting riders.
+ */
+struct ScoreRule {
+  enum Event { DELIVERY, ELAPSED, CROWDING };
+
+  const char *name;
+  Event event;
+  int points;
+  long long periodMs; // ELAPSED and CROWDING only
+  int threshold;      // CROWDING only
+};
+
+/**
+ * @brief Computes the score from simulation events and simulated time.
+ *
+ * Every rule is evaluated inside the tick against the simulated clock, so
+ * a run scores the same at any time-warp, headless or not. Penalties never
+ * take the score below zero.
+ */
+class ScoreKeeper {
+private:
+  std::vector<ScoreRule> rules;
+  std::vector<long long> nextDueMs; // per rule, for periodic rules
+  std::vector<int> totals;          // points awarded so far, per rule
+  int score;
+
+  void apply(size_t rule, int points);
+
+public:
+  ScoreKeeper();
+
+  /**
+   * @brief The default table: +10 per delivery, -2 every 10 s, and -1 every
+   * 10 s for each station with more than 6 riders waiting
+   */
+  static const std::vector<ScoreRule> &defaultRules();
+
+  /**
+   * @brief Replace the rule table and restart scoring from zero
+   */
+  void setRules(const std::vector<ScoreRule> &table);
+  const std::vector<ScoreRule> &getRules() const { return rules; }
+
+  /**
+   * @brief Reset the score and every rule's schedule
+   */
+  void reset();
+
+  /**
+   * @brief Score passengers delivered during a tick
+   */
+  void onDeliveries(int count);
+
+  /**
+   * @brief Fire the periodic rules that fell due up to the given time
+   * @param elapsedMs Simulated time at the end of the tick
+   */
+  void onTick(long long elapsedMs, const std::vector<SimStation> &stations);
+
+  /**
+   * @brief Simulated time at which the next periodic rule falls due, or
+   * LLONG_MAX if there is none
+   */
+  long long getNextDueMs() const;
+
+  int getScore() const { return score; }
+  void setScore(int s) { score = s; }
+  void addScore(int points) { score += points; }
+
+  /**
+   * @brief Points awarded so far by a rule (its index in getRules())
+   */
+  int getTotal(size_t rule) const { return totals[rule]; }
+};
+
+#endif // SCORING_H
@@ -0,0 +1,68 @@
+#ifndef SIM_CLOCK_H
+#define SIM_CLOCK_H
+
+/**
+ * @brief Converts variable frame times into a whole number of fixed ticks.
+ *
+ * The simulation only ever advances in steps of getTickMs(), so a slow frame
+ * produces more ticks rather than a bigger step and cannot change the
+ * outcome of a run. Frame time is scaled by the time-warp factor before
+ * being accumulated; any remainder smaller than a tick carries over to the
+ * next frame.
+ */
+class SimClock {
+public:
+  static constexpr float kMinWarp = 1.0f;
+  static constexpr float kMaxWarp = 1000.0f;
+
+  /// Upper bound on ticks run for a single frame, so a long stall (window
+  /// drag, breakpoint) does not freeze the UI while the sim catches up
+  static constexpr int kMaxTicksPerFrame = 20000;
+
+private:
+  int tickMs;
+  float warp;
+  double accumulatorMs;
+
+public:
+  explicit SimClock(int tick = 10)
+      : tickMs(tick), warp(1.0f), accumulatorMs(0.0) {}
+
+  /**
+   * @brief Account for one frame
+   * @param frameMs Wall-clock milliseconds since the previous frame
+   * @return Number of fixed ticks the simulation should run this frame
+   */
+  int advance(float frameMs) {
+    if (frameMs > 0.0f)
+      accumulatorMs += (double)frameMs * warp;
+
+    int ticks = (int)(accumulatorMs / tickMs);
+    if (ticks > kMaxTicksPerFrame) {
+      // Drop the backlog rather than trying to catch up on it
+      ticks = kMaxTicksPerFrame;
+      accumulatorMs = 0.0;
+    } else {
+      accumulatorMs -= (double)ticks * tickMs;
+    }
+    return ticks;
+  }
+
+  /**
+   * @brief Forget any partially accumulated frame time
+   */
+  void reset() { accumulatorMs = 0.0; }
+
+  int getTickMs() const { return tickMs; }
+
+  float getWarp() const { return warp; }
+  void setWarp(float w) {
+    if (w < kMinWarp)
+      w = kMinWarp;
+    if (w > kMaxWarp)
+      w = kMaxWarp;
+    warp = w;
+  }
+};
+
+#endif // SIM_CLOCK_H
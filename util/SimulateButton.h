@@ -37,7 +37,12 @@ public:
         float top = y - height / 2.0f;
         float bottom = y + height / 2.0f;
 
-        if (mx >= left && mx <= right && my >= top && my <= bottom) {
+        bool hovering = mx >= left && mx <= right && my >= top && my <= bottom;
+        if (hovering != isHovered) {
+            markDirty();
+        }
+
+        if (hovering) {
             isHovered = true;
             if (mouse.button_left_pressed && !wasPressed) {
                 if (onClickCallback) {
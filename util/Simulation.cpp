@@ -0,0 +1,539 @@
+#include "Simulation.h"
+#include "Profiler.h"
+#include <algorithm>
+#include <climits>
+#include <cmath>
+
+Simulation::Simulation()
+    : routesStale(false), dispatch(new DemandWeightedPolicy()),
+      journalScore(0), topologyVersion(0), layoutVersion(0),
+      lineSpeed(kDefaultLineSpeed), engine(TICKED), arrivalsByWorker(1),
+      deltas(1), resolvingArrivals(false), seed(0), elapsedMs(0),
+      stepCount(0), arrivalCount(0), debugMode(false) {}
+
+void Simulation::setThreadCount(int threads) {
+  if (threads <= 1)
+    pool.reset();
+  else if (threads != getThreadCount())
+    pool.reset(new WorkerPool(threads));
+  arrivalsByWorker.resize(getThreadCount());
+  deltas.resize(getThreadCount());
+}
+
+void Simulation::runParallel(size_t count, size_t grain,
+                             const WorkerPool::RangeFn &fn) {
+  if (pool)
+    pool->parallelFor(count, grain, fn);
+  else if (count > 0)
+    fn(0, count, 0);
+}
+
+void Simulation::clear() {
+  stations.clear();
+  stationNames.clear();
+  stationByName.clear();
+  trains.clear();
+  passengers.clear();
+  routes.clear();
+  routesStale = false;
+  dispatch->reset();
+  demand.reset();
+  trainEvents = decltype(trainEvents)();
+  topologyVersion++;
+  layoutVersion++;
+  scoring.reset();
+  journalScore = scoring.getScore();
+  waitTimes.clear();
+  elapsedMs = 0;
+  stepCount = 0;
+  arrivalCount = 0;
+}
+
+int Simulation::addStation(std::string_view name, float x, float y) {
+  SimStation station;
+  station.nameId = stationNames.intern(name);
+  if (station.nameId >= stationByName.size())
+    stationByName.resize(station.nameId + 1);
+  stationByName[station.nameId] = (int)stations.size();
+  station.x = x;
+  station.y = y;
+  station.waitingCount = 0;
+  stations.push_back(station);
+  routesStale = true;
+  topologyVersion++;
+  return (int)stations.size() - 1;
+}
+
+void Simulation::connect(int from, int to) {
+  if (from < 0 || to < 0 || from >= (int)stations.size() ||
+      to >= (int)stations.size() ||
+      (int)stations[from].next.size() >= RoutingTable::kMaxConnections)
+    return;
+  stations[from].next.push_back(to);
+  stations[from].waitingByHop.resize(stations[from].next.size());
+  stations[from].edges.resize(stations[from].next.size());
+  measureEdge(from, (int)stations[from].next.size() - 1);
+  stations[to].prev.push_back(from);
+  routesStale = true;
+  topologyVersion++;
+}
+
+void Simulation::measureEdge(int station, int slot) {
+  const SimStation &from = stations[station];
+  const SimStation &to = stations[from.next[slot]];
+  float dx = to.x - from.x;
+  float dy = to.y - from.y;
+  SimEdge &edge = stations[station].edges[slot];
+  edge.length = std::sqrt(dx * dx + dy * dy);
+  edge.dirX = edge.length > 0.0f ? dx / edge.length : 0.0f;
+  edge.dirY = edge.length > 0.0f ? dy / edge.length : 0.0f;
+  // The canvas y axis points down, SGG's angles turn counter-clockwise
+  edge.angle = std::atan2(-dy, dx) * 180.0f / 3.14159265f;
+}
+
+void Simulation::setLineSpeed(float pixelsPerSecond) {
+  if (pixelsPerSecond > 0.0f)
+    lineSpeed = pixelsPerSecond;
+}
+
+void Simulation::setEngine(Engine e) {
+  if (e == engine)
+    return;
+  engine = e;
+  trainEvents = decltype(trainEvents)();
+  if (engine == EVENT_DRIVEN) {
+    for (int id = 0; id < (int)trains.size(); ++id)
+      scheduleArrival(id);
+  } else {
+    syncTrainPositions();
+  }
+}
+
+void Simulation::scheduleArrival(int id) {
+  const SimTrain &train = trains[id];
+  if (train.nextSlot < 0)
+    return;
+  // The tick that notices the arrival: the first one ending at or after it
+  long long tick = (train.arriveMs + kFixedStepMs - 1) / kFixedStepMs *
+                   kFixedStepMs;
+  trainEvents.push(TrainEvent(tick, id));
+}
+
+void Simulation::buildRoutes() {
+  ProfileScope scope("routes");
+  routes.build(stations);
+  routesStale = false;
+
+  // Riders queued under the old routes may have a different next hop now
+  std::vector<int> riders;
+  for (int s = 0; s < (int)stations.size(); ++s) {
+    SimStation &station = stations[s];
+    if (station.waitingCount == 0)
+      continue;
+    riders.clear();
+    station.forEachWaiting([&](int pid) { riders.push_back(pid); });
+    for (RingQueue<int> &queue : station.waitingByHop)
+      queue.clear();
+    station.unrouted.clear();
+    station.waitingCount = 0;
+    for (int pid : riders)
+      enqueueWaiting(s, pid);
+  }
+}
+
+void Simulation::enqueueWaiting(int stationId, int passengerId) {
+  SimStation &station = stations[stationId];
+  uint8_t slot =
+      routes.nextHopSlot(stationId, passengers.getDestination(passengerId));
+  if (slot == RoutingTable::kNoRoute)
+    station.unrouted.push_back(passengerId);
+  else
+    station.waitingByHop[slot].push_back(passengerId);
+  station.waitingCount++;
+}
+
+int Simulation::addTrain(int startStation) {
+  if (routesStale)
+    buildRoutes();
+
+  SimTrain train;
+  train.currentStation = startStation;
+  train.nextStation = -1;
+  train.nextSlot = -1;
+  train.previousStation = -1;
+  train.departMs = train.arriveMs = elapsedMs;
+  train.x = stations[startStation].x;
+  train.y = stations[startStation].y;
+  train.capacity = 6;
+  train.passengers.reserve(train.capacity);
+  train.rng = makeRng(Rng::TRAIN, trains.size());
+  trains.push_back(train);
+
+  // Pick initial next station if available
+  int id = (int)trains.size() - 1;
+  pickNextStation(id, elapsedMs);
+  if (engine == EVENT_DRIVEN)
+    scheduleArrival(id);
+  return id;
+}
+
+int Simulation::addPassenger(int origin, int destination) {
+  if (routesStale)
+    buildRoutes();
+
+  int id = passengers.add(PassengerStore::WAITING, destination, origin,
+                          stations[origin].x, stations[origin].y);
+  passengers.setWaitingSince(id, (uint64_t)elapsedMs);
+  enqueueWaiting(origin, id);
+  if (journal) {
+    JournalEvent event = {(uint64_t)elapsedMs, JournalEvent::SPAWN, {},
+                          id, -1, origin, destination};
+    journal->record(event);
+  }
+  return id;
+}
+
+void Simulation::journalEvent(std::vector<JournalEvent> &out, uint8_t type,
+                              long long nowMs, int passenger, int train,
+                              int station, int value) const {
+  JournalEvent event = {(uint64_t)nowMs, type, {}, passenger, train,
+                        station, value};
+  out.push_back(event);
+}
+
+void Simulation::step(int ms) {
+  if (engine == EVENT_DRIVEN) {
+    long long targetMs = elapsedMs + ms;
+    while (elapsedMs < targetMs)
+      runNextEvent(targetMs);
+    return;
+  }
+
+  ProfileScope scope("tick");
+  if (routesStale)
+    buildRoutes();
+  long long nowMs = elapsedMs + ms;
+
+  // Phase 1: move the trains, noting which ones reached a station
+  for (auto &list : arrivalsByWorker)
+    list.clear();
+  runParallel(trains.size(), kTrainGrain,
+              [this, nowMs](size_t begin, size_t end, int worker) {
+                ProfileScope chunk("tick.advance");
+                std::vector<std::pair<int, int>> &list =
+                    arrivalsByWorker[worker];
+                for (size_t i = begin; i < end; ++i) {
+                  if (advanceTrain((int)i, nowMs))
+                    list.push_back(std::make_pair(trains[i].nextStation, i));
+                }
+              });
+
+  // Phase 2: let them stop
+  arrivals.clear();
+  for (const auto &list : arrivalsByWorker)
+    arrivals.insert(arrivals.end(), list.begin(), list.end());
+  arrivalCount += (long long)arrivals.size();
+  if (!arrivals.empty())
+    resolveArrivals(nowMs);
+  finishTick(nowMs);
+}
+
+long long Simulation::nextEventMs() const {
+  long long next = LLONG_MAX;
+  if (!trainEvents.empty())
+    next = trainEvents.top().first;
+  if (demand && !demand->isFinished(elapsedMs)) {
+    double arrival = demand->getNextArrivalMs();
+    if (demand->getEndMs() < 0 || arrival <= (double)demand->getEndMs())
+      next = std::min(next, (long long)std::ceil(arrival));
+  }
+  next = std::min(next, scoring.getNextDueMs());
+  if (next == LLONG_MAX)
+    return next;
+
+  // Round up onto the tick grid, and never back into the past
+  next = (next + kFixedStepMs - 1) / kFixedStepMs * kFixedStepMs;
+  long long firstTick = (elapsedMs / kFixedStepMs + 1) * kFixedStepMs;
+  return std::max(next, firstTick);
+}
+
+void Simulation::runNextEvent(long long limitMs) {
+  long long nowMs = nextEventMs();
+  if (nowMs > limitMs) {
+    elapsedMs = limitMs; // nothing happens before the limit
+    return;
+  }
+
+  ProfileScope scope("tick");
+  if (routesStale)
+    buildRoutes();
+
+  arrivals.clear();
+  while (!trainEvents.empty() && trainEvents.top().first <= nowMs) {
+    int id = trainEvents.top().second;
+    trainEvents.pop();
+    arrivals.push_back(std::make_pair(trains[id].nextStation, id));
+  }
+  arrivalCount += (long long)arrivals.size();
+  if (!arrivals.empty()) {
+    resolveArrivals(nowMs);
+    for (const auto &arrival : arrivals)
+      scheduleArrival(arrival.second);
+  }
+  finishTick(nowMs);
+}
+
+void Simulation::finishTick(long long nowMs) {
+  elapsedMs = nowMs;
+  stepCount++;
+
+  // New riders who turned up during this tick
+  if (demand) {
+    ProfileScope demandScope("tick.demand");
+    demand->generate(*this, elapsedMs);
+  }
+
+  scoring.onTick(elapsedMs, stations);
+  if (journal && scoring.getScore() != journalScore) {
+    journalScore = scoring.getScore();
+    JournalEvent event = {(uint64_t)elapsedMs, JournalEvent::SCORE, {},
+                          -1, -1, -1, journalScore};
+    journal->record(event);
+  }
+
+  // No lookups run between ticks, so cold routes can be dropped here
+  routes.trim();
+}
+
+void Simulation::resolveArrivals(long long nowMs) {
+  ProfileScope scope("tick.arrivals");
+  // Group the arrivals by station; a station's trains stop in id order
+  std::sort(arrivals.begin(), arrivals.end());
+  stationGroups.clear();
+  for (size_t i = 0; i < arrivals.size(); ++i) {
+    if (i == 0 || arrivals[i].first != arrivals[i - 1].first)
+      stationGroups.push_back(i);
+  }
+  stationGroups.push_back(arrivals.size());
+
+  waitingSnapshot.resize(stations.size());
+  for (size_t s = 0; s < stations.size(); ++s)
+    waitingSnapshot[s] = stations[s].waitingCount;
+  for (TickDelta &delta : deltas) {
+    delta.deliveries = 0;
+    for (long long &count : delta.stateCounts)
+      count = 0;
+    delta.delivered.clear();
+    delta.events.clear();
+    delta.waits.clear();
+  }
+  dispatch->prepare((int)trains.size());
+
+  // Each station, with its queues and the riders on its arriving trains,
+  // belongs to exactly one worker
+  resolvingArrivals = true;
+  runParallel(stationGroups.size() - 1, kStationGrain,
+              [this, nowMs](size_t begin, size_t end, int worker) {
+                ProfileScope chunk("tick.arrivals.stations");
+                for (size_t g = begin; g < end; ++g) {
+                  for (size_t i = stationGroups[g]; i < stationGroups[g + 1];
+                       ++i)
+                    arriveAtStation(arrivals[i].second, nowMs, deltas[worker]);
+                }
+              });
+  resolvingArrivals = false;
+
+  ProfileScope merge("tick.arrivals.merge");
+  // Workers own contiguous runs of stations, so walking the deltas in
+  // worker order retires riders in the same order as a serial tick and the
+  // free list (and with it every later passenger id) does not depend on
+  // the thread count
+  for (const TickDelta &delta : deltas) {
+    scoring.onDeliveries(delta.deliveries);
+    passengers.applyCountDelta(delta.stateCounts);
+    if (journal) {
+      for (const JournalEvent &event : delta.events)
+        journal->record(event);
+    }
+    for (uint32_t ms : delta.waits)
+      waitTimes.add(ms);
+    for (int pid : delta.delivered)
+      passengers.retire(pid);
+  }
+}
+
+RunResult Simulation::runUntilDone(long long maxSimMs) {
+  while (!isRunOver() && elapsedMs < maxSimMs) {
+    if (engine == EVENT_DRIVEN)
+      runNextEvent(maxSimMs);
+    else
+      step(kFixedStepMs);
+  }
+  return getResult();
+}
+
+RunResult Simulation::getResult() const {
+  RunResult result;
+  result.allArrived = isRunOver();
+  result.score = getScore();
+  result.simMs = elapsedMs;
+  result.steps = stepCount;
+  result.passengers = getTotalPassengers();
+  result.completed = getCompletedPassengers();
+  result.throughputPerMinute =
+      elapsedMs > 0 ? result.completed * 60000.0 / elapsedMs : 0.0;
+  return result;
+}
+
+void Simulation::setStationPosition(int id, float x, float y) {
+  SimStation &station = stations[id];
+  station.x = x;
+  station.y = y;
+
+  // Re-measure the connections leaving and entering this station
+  for (int k = 0; k < (int)station.next.size(); ++k)
+    measureEdge(id, k);
+  for (int from : station.prev) {
+    const std::vector<int> &next = stations[from].next;
+    for (int k = 0; k < (int)next.size(); ++k) {
+      if (next[k] == id)
+        measureEdge(from, k);
+    }
+  }
+  layoutVersion++;
+}
+
+void Simulation::setPassengerPosition(int id, float x, float y) {
+  passengers.setPosition(id, x, y);
+}
+
+bool Simulation::advanceTrain(int id, long long nowMs) {
+  SimTrain &train = trains[id];
+  if (train.currentStation < 0 || train.nextSlot < 0)
+    return false;
+  if (nowMs >= train.arriveMs)
+    return true;
+  positionTrain(train, nowMs);
+  return false;
+}
+
+void Simulation::positionTrain(SimTrain &train, long long nowMs) {
+  if (train.nextSlot < 0)
+    return;
+  // Share of the trip done, applied to the edge as it is now, so a train
+  // follows its track when a station is dragged and still arrives on time
+  float done = (float)(nowMs - train.departMs) /
+               (float)(train.arriveMs - train.departMs);
+  done = std::min(done, 1.0f);
+  const SimStation &from = stations[train.currentStation];
+  const SimEdge &edge = from.edges[train.nextSlot];
+  train.x = from.x + edge.dirX * edge.length * done;
+  train.y = from.y + edge.dirY * edge.length * done;
+}
+
+void Simulation::syncTrainPositions() {
+  if (engine != EVENT_DRIVEN)
+    return;
+  for (SimTrain &train : trains)
+    positionTrain(train, elapsedMs);
+}
+
+void Simulation::pickNextStation(int id, long long nowMs) {
+  SimTrain &train = trains[id];
+  train.nextStation = dispatch->pickNext(*this, id, train.rng);
+  train.nextSlot = -1;
+
+  if (train.nextStation >= 0) {
+    const std::vector<int> &next = stations[train.currentStation].next;
+    for (int k = 0; k < (int)next.size(); ++k) {
+      if (next[k] == train.nextStation) {
+        train.nextSlot = k;
+        break;
+      }
+    }
+  }
+
+  // The trip takes its length at line speed, and at least a millisecond,
+  // so the train is always seen moving for a tick before it arrives
+  train.departMs = train.arriveMs = nowMs;
+  if (train.nextSlot >= 0) {
+    float length = stations[train.currentStation].edges[train.nextSlot].length;
+    long long tripMs = (long long)std::ceil(length * 1000.0f / lineSpeed);
+    train.arriveMs = nowMs + std::max(tripMs, 1LL);
+  }
+}
+
+void Simulation::arriveAtStation(int id, long long nowMs, TickDelta &delta) {
+  SimTrain &train = trains[id];
+  train.previousStation = train.currentStation;
+  train.currentStation = train.nextStation;
+  train.nextStation = -1;
+
+  SimStation &station = stations[train.currentStation];
+  train.x = station.x;
+  train.y = station.y;
+
+  // Riders are removed by swapping in the last seat, so every pass below
+  // is O(capacity) and nothing is shifted or allocated.
+  std::vector<int> &seats = train.passengers;
+
+  // 1. Disembark passengers who have arrived
+  for (size_t i = 0; i < seats.size();) {
+    int pid = seats[i];
+    if (passengers.getDestination(pid) == train.currentStation) {
+      passengers.setState(pid, PassengerStore::COMPLETED, delta.stateCounts);
+      passengers.setLocation(pid, train.currentStation);
+      seats[i] = seats.back();
+      seats.pop_back();
+      delta.deliveries++;
+      delta.delivered.push_back(pid);
+      if (journal)
+        journalEvent(delta.events, JournalEvent::ARRIVE, nowMs, pid, id,
+                     train.currentStation);
+    } else {
+      ++i;
+    }
+  }
+
+  // 2. Decide where to go next, so riders know whether to stay on
+  pickNextStation(id, nowMs);
+
+  // 3. Riders whose route leaves this train here change trains
+  for (size_t i = 0; i < seats.size();) {
+    int pid = seats[i];
+    int slot =
+        routes.nextHopSlot(train.currentStation, passengers.getDestination(pid));
+    if (slot != train.nextSlot) {
+      passengers.setState(pid, PassengerStore::WAITING, delta.stateCounts);
+      passengers.setLocation(pid, train.currentStation);
+      passengers.setWaitingSince(pid, (uint64_t)nowMs);
+      enqueueWaiting(train.currentStation, pid);
+      seats[i] = seats.back();
+      seats.pop_back();
+      if (journal)
+        journalEvent(delta.events, JournalEvent::ALIGHT, nowMs, pid, id,
+                     train.currentStation);
+    } else {
+      ++i;
+    }
+  }
+
+  // 4. Board riders queued for this train's next stop, up to capacity
+  if (train.nextSlot < 0)
+    return;
+
+  RingQueue<int> &queue = station.waitingByHop[train.nextSlot];
+  while (!queue.empty() && (int)seats.size() < train.capacity) {
+    int pid = queue.pop_front();
+    station.waitingCount--;
+    passengers.setState(pid, PassengerStore::ON_TRAIN, delta.stateCounts);
+    passengers.setLocation(pid, id);
+    seats.push_back(pid);
+    // The histogram counts in 32 bits; a 49-day wait is as good as forever
+    uint64_t waited = (uint64_t)nowMs - passengers.getWaitingSince(pid);
+    delta.waits.push_back((uint32_t)std::min<uint64_t>(waited, UINT32_MAX));
+    if (journal)
+      journalEvent(delta.events, JournalEvent::BOARD, nowMs, pid, id,
+                   train.currentStation);
+  }
+}
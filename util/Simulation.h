@@ -0,0 +1,463 @@
+#ifndef SIMULATION_H
+#define SIMULATION_H
+
+#include "Demand.h"
+#include "Dispatch.h"
+#include "Histogram.h"
+#include "Journal.h"
+#include "PassengerStore.h"
+#include "RingQueue.h"
+#include "Rng.h"
+#include "Routing.h"
+#include "Scoring.h"
+#include "StringInterner.h"
+#include "WorkerPool.h"
+#include <cstdint>
+#include <functional>
+#include <memory>
+#include <queue>
+#include <string>
+#include <string_view>
+#include <utility>
+#include <vector>
+
+/**
+ * @brief Cached geometry of one connection, measured when it is made and
+ * again whenever either end station moves, so nothing that runs per train
+ * per tick needs a square root or trigonometry
+ */
+struct SimEdge {
+  float length; // in canvas pixels
+  float dirX;   // unit vector from the station towards next[k]
+  float dirY;   // (0, 0) if both ends are in the same place
+  float angle;  // heading in degrees, as graphics::setOrientation() takes it
+};
+
+/**
+ * @brief Simulation-side data for a single station.
+ *
+ * Stations are identified by their index in Simulation::getStations(), and
+ * their names are interned (see Simulation::getStationName()), so trains,
+ * passengers and routes only ever refer to a station by its 4-byte id.
+ * Nothing here depends on SGG, so the core can run without a window.
+ *
+ * Waiting riders are queued by their next hop: waitingByHop[k] holds, in
+ * arrival order, the riders whose route continues to next[k], so a train
+ * heading to next[k] boards by popping that one queue, and edges[k] holds
+ * the geometry of the connection to next[k].
+ */
+struct SimStation {
+  uint32_t nameId; // in the simulation's name interner
+  float x;
+  float y;
+  std::vector<int> next; // ids of stations reachable from here
+  std::vector<SimEdge> edges;               // parallel to next
+  std::vector<int> prev; // ids of stations with a connection to here
+  std::vector<RingQueue<int>> waitingByHop; // parallel to next
+  RingQueue<int> unrouted; // riders with no route from here
+  int waitingCount;        // riders in all queues
+
+  /**
+   * @brief Visit every waiting rider id, queue by queue
+   */
+  template <typename F> void forEachWaiting(F f) const {
+    for (const RingQueue<int> &queue : waitingByHop) {
+      for (size_t i = 0; i < queue.size(); ++i)
+        f(queue[i]);
+    }
+    for (size_t i = 0; i < unrouted.size(); ++i)
+      f(unrouted[i]);
+  }
+};
+
+/**
+ * @brief Simulation-side data for a single train.
+ */
+struct SimTrain {
+  int currentStation;
+  int nextStation;
+  int nextSlot; // index of nextStation in the current station's next list
+  int previousStation;
+  long long departMs; // simulated time it left currentStation
+  long long arriveMs; // and will reach nextStation, fixed on departure
+  float x; // as of the last tick, or Simulation::syncTrainPositions()
+  float y;
+  int capacity;
+  std::vector<int> passengers; // reserved to capacity, never reallocates
+  Rng rng; // this train's own stream, see Rng::TRAIN
+};
+
+/**
+ * @brief Outcome of a simulation run, handed to end-of-run hooks
+ */
+struct RunResult {
+  bool allArrived;   // false if the run stopped on a time limit
+  int score;
+  long long simMs;   // simulated time when the run ended
+  long long steps;
+  int passengers;
+  int completed;
+  double throughputPerMinute; // completed journeys per simulated minute
+};
+
+/**
+ * @brief Headless simulation core of the Athens Metro Manager.
+ *
+ * Owns every station, train and passenger as plain data and advances them
+ * with step(). Passengers are kept in a struct-of-arrays PassengerStore and
+ * follow shortest routes from a RoutingTable: they only board
+ * a train whose next stop is their next hop, and change trains when the
+ * train leaves their route. Where trains go is decided by a pluggable
+ * DispatchPolicy. It has no dependency on SGG: the interactive build wraps it
+ * in VisualAsset views, while the headless runner drives it directly at a
+ * fixed timestep.
+ *
+ * Riders are retired as soon as they are delivered, so their PassengerStore
+ * slots are recycled and the store stays at the peak number of riders in
+ * the system.
+ *
+ * All randomness is drawn from Rng streams derived from the run seed, so a
+ * given seed and the same sequence of step() calls reproduce a run exactly.
+ *
+ * A tick runs in two phases. First every train moves; trains do not
+ * interact, so this is split across the worker pool. Then the trains that
+ * reached a station are resolved grouped by station, each station owned by
+ * one worker, in station then train order. Dispatch reads neighbouring
+ * stations as they were at the start of that phase, and deliveries and
+ * state count changes are summed per worker and merged at the end, so the
+ * result is the same for any number of threads.
+ *
+ * A train's arrival time is fixed when it leaves a station, from the track
+ * length and the line speed. That lets the EVENT_DRIVEN engine keep the
+ * trains in a priority queue by arrival time and jump from one tick where
+ * something happens (an arrival, a demand arrival or a scoring rule falling
+ * due) straight to the next, skipping the ticks in between. Events land on
+ * the same kFixedStepMs grid as in the TICKED engine, so both give the same
+ * run for a seed.
+ */
+class Simulation {
+public:
+  /// Timestep used when the simulation is driven headless
+  static constexpr int kFixedStepMs = 10;
+  /// Default train speed, in canvas pixels per simulated second
+  static constexpr float kDefaultLineSpeed = 90.0f;
+
+  /**
+   * @brief How step() advances time. TICKED moves every train every tick;
+   * EVENT_DRIVEN only runs the ticks at which something happens, and
+   * computes train positions on demand (see syncTrainPositions()).
+   */
+  enum Engine { TICKED, EVENT_DRIVEN };
+
+  Simulation();
+
+  // Non-copyable: views keep references into the simulation
+  Simulation(const Simulation &) = delete;
+  Simulation &operator=(const Simulation &) = delete;
+
+  /**
+   * @brief Remove every station, train and passenger and reset the clock
+   */
+  void clear();
+
+  /**
+   * @brief Set the run seed. Must be called before entities are created,
+   * since each train derives its stream from it on construction.
+   */
+  void setSeed(uint64_t s) { seed = s; }
+  uint64_t getSeed() const { return seed; }
+
+  /**
+   * @brief Derive an independent random stream from the run seed
+   */
+  Rng makeRng(Rng::Domain domain, uint64_t index = 0) const {
+    return Rng::forEntity(seed, domain, index);
+  }
+
+  // Construction
+  int addStation(std::string_view name, float x, float y);
+
+  /**
+   * @brief Add a one-way connection. Ignored if either id is out of range
+   * or the station already has RoutingTable::kMaxConnections connections;
+   * loadNetwork() rejects such networks up front.
+   */
+  void connect(int from, int to);
+  int addTrain(int startStation);
+  int addPassenger(int origin, int destination);
+
+  /**
+   * @brief Recompute the routing table. Called by the loader once the
+   * network is complete; step() also rebuilds it if connections changed.
+   */
+  void buildRoutes();
+
+  /**
+   * @brief Next station on a shortest route from one station to another
+   * @return Station id, or -1 if from == to or there is no route
+   */
+  int nextHop(int from, int to) const {
+    uint8_t slot = routes.nextHopSlot(from, to);
+    return slot == RoutingTable::kNoRoute ? -1 : stations[from].next[slot];
+  }
+
+  const RoutingTable &getRoutes() const { return routes; }
+
+  /// Bytes of per-destination routes kept between ticks, see RoutingTable
+  void setRouteCacheBudget(size_t bytes) { routes.setCacheBudget(bytes); }
+
+  /**
+   * @brief Geometry of the connection from a station to its slot-th next
+   * station
+   */
+  const SimEdge &getEdge(int station, int slot) const {
+    return stations[station].edges[slot];
+  }
+
+  /**
+   * @brief Set how fast every train travels along a connection, in canvas
+   * pixels per simulated second, so a trip takes time in proportion to the
+   * length of the track. Applies from each train's next departure; values
+   * of zero or less are ignored.
+   */
+  void setLineSpeed(float pixelsPerSecond);
+  float getLineSpeed() const { return lineSpeed; }
+
+  /**
+   * @brief Replace the train dispatch policy (demand-weighted by default).
+   * Takes effect the next time each train leaves a station.
+   */
+  void setDispatchPolicy(std::unique_ptr<DispatchPolicy> policy) {
+    if (policy)
+      dispatch = std::move(policy);
+  }
+  const DispatchPolicy &getDispatchPolicy() const { return *dispatch; }
+
+  /**
+   * @brief Spawn passengers continuously from a demand generator, at the
+   * end of every tick (nullptr to stop). The run then only ends once the
+   * generator has finished and everyone has arrived.
+   */
+  void setDemand(std::unique_ptr<DemandGenerator> generator) {
+    demand = std::move(generator);
+  }
+  const DemandGenerator *getDemand() const { return demand.get(); }
+
+  /**
+   * @brief Record spawns, boardings, alightings, arrivals and score changes
+   * to an open journal (nullptr to stop). Events from a parallel tick are
+   * recorded in the same order as a serial one.
+   */
+  void setJournal(std::unique_ptr<Journal> events) {
+    journal = std::move(events);
+    journalScore = scoring.getScore();
+  }
+  Journal *getJournal() { return journal.get(); }
+
+  /**
+   * @brief Pick the engine. Can be switched at any time between steps.
+   */
+  void setEngine(Engine e);
+  Engine getEngine() const { return engine; }
+
+  /**
+   * @brief Advance the simulation
+   * @param ms Milliseconds of simulated time to advance by. The
+   * EVENT_DRIVEN engine advances by the same amount but only runs the
+   * ticks in it where something happens.
+   */
+  void step(int ms);
+
+  /**
+   * @brief Bring every train's x and y up to the current time. The TICKED
+   * engine keeps them current on its own; the EVENT_DRIVEN one only moves
+   * trains here, so views call this before drawing.
+   */
+  void syncTrainPositions();
+
+  /**
+   * @brief Number of threads a tick may use (1, the default, is serial)
+   */
+  void setThreadCount(int threads);
+  int getThreadCount() const { return pool ? pool->size() : 1; }
+
+  /**
+   * @brief Step at kFixedStepMs until the run is over (see isRunOver()) or
+   * maxSimMs elapsed
+   * @return Result of the run
+   */
+  RunResult runUntilDone(long long maxSimMs);
+
+  /**
+   * @brief Check whether every spawned passenger reached their destination
+   */
+  bool allPassengersArrived() const {
+    return passengers.getSpawnedCount() > 0 &&
+           passengers.countIn(PassengerStore::WAITING) == 0 &&
+           passengers.countIn(PassengerStore::ON_TRAIN) == 0;
+  }
+
+  /**
+   * @brief Whether the run is complete: everyone spawned has arrived and
+   * the demand generator, if any, will spawn no one else
+   */
+  bool isRunOver() const {
+    return allPassengersArrived() && (!demand || demand->isFinished(elapsedMs));
+  }
+
+  /// Passengers spawned so far, including those already retired
+  int getTotalPassengers() const { return (int)passengers.getSpawnedCount(); }
+  int getCompletedPassengers() const {
+    return (int)(passengers.getRetiredCount() +
+                 passengers.countIn(PassengerStore::COMPLETED));
+  }
+
+  /**
+   * @brief Handle to a passenger, for holding on to it across ticks. Ids
+   * are reused once a rider arrives and is retired; the handle tells the
+   * difference.
+   */
+  Handle getPassengerHandle(int id) const { return passengers.handle(id); }
+  bool isPassengerLive(Handle h) const { return passengers.isValid(h); }
+
+  /**
+   * @brief Snapshot of the run so far
+   */
+  RunResult getResult() const;
+
+  /**
+   * @brief How long riders waited at a station for each train they
+   * boarded, in simulated milliseconds
+   */
+  const Histogram &getWaitTimes() const { return waitTimes; }
+
+  // Accessors
+  const std::vector<SimStation> &getStations() const { return stations; }
+  const std::vector<SimTrain> &getTrains() const { return trains; }
+  const PassengerStore &getPassengers() const { return passengers; }
+  const SimStation &getStation(int id) const { return stations[id]; }
+  const std::string &getStationName(int id) const {
+    return stationNames.get(stations[id].nameId);
+  }
+
+  /**
+   * @brief Station id by name, through the interner's hash table
+   * @return The id (the last station added under that name), or -1
+   */
+  int findStation(std::string_view name) const {
+    uint32_t nameId = stationNames.find(name);
+    return nameId == StringInterner::kNotFound ? -1 : stationByName[nameId];
+  }
+  const SimTrain &getTrain(int id) const { return trains[id]; }
+
+  /**
+   * @brief Riders waiting at a station, as dispatch policies should see
+   * them: while arrivals are being resolved this is the count from the
+   * start of that phase, so no station depends on another being resolved
+   * first
+   */
+  int getWaitingForDispatch(int id) const {
+    return resolvingArrivals ? waitingSnapshot[id] : stations[id].waitingCount;
+  }
+
+  void setStationPosition(int id, float x, float y);
+  void setPassengerPosition(int id, float x, float y);
+
+  /**
+   * @brief Counters bumped whenever stations or connections are added
+   * (topology) or a station moves (layout), so caches built from the
+   * network can tell when they are stale without comparing contents
+   */
+  uint64_t getTopologyVersion() const { return topologyVersion; }
+  uint64_t getLayoutVersion() const { return layoutVersion; }
+
+  long long getElapsedMs() const { return elapsedMs; }
+  /// Ticks run so far; the EVENT_DRIVEN engine skips the idle ones
+  long long getStepCount() const { return stepCount; }
+  /// Train arrivals at a station so far
+  long long getArrivalCount() const { return arrivalCount; }
+
+  // Score management, see ScoreKeeper for the rules
+  int getScore() const { return scoring.getScore(); }
+  void setScore(int newScore) { scoring.setScore(newScore); }
+  void addScore(int points) { scoring.addScore(points); }
+  void setScoreRules(const std::vector<ScoreRule> &rules) {
+    scoring.setRules(rules);
+  }
+  const ScoreKeeper &getScoring() const { return scoring; }
+
+  bool isDebugMode() const { return debugMode; }
+  void setDebugMode(bool debug) { debugMode = debug; }
+
+private:
+  /// Changes made by one worker during a tick, merged once it is over.
+  /// Aligned so that workers never share a cache line.
+  struct alignas(64) TickDelta {
+    int deliveries;
+    long long stateCounts[PassengerStore::kStateCount];
+    std::vector<int> delivered; // riders to retire, in resolution order
+    std::vector<JournalEvent> events; // for the journal, if there is one
+    std::vector<uint32_t> waits;      // ms waited by each rider who boarded
+  };
+
+  /// Below these sizes a phase runs inline rather than waking the pool
+  static constexpr size_t kTrainGrain = 1024;
+  static constexpr size_t kStationGrain = 16;
+
+  bool advanceTrain(int id, long long nowMs);
+  void positionTrain(SimTrain &train, long long nowMs);
+  void resolveArrivals(long long nowMs);
+  void finishTick(long long nowMs);
+  long long nextEventMs() const;
+  void runNextEvent(long long limitMs);
+  void scheduleArrival(int id);
+  void journalEvent(std::vector<JournalEvent> &out, uint8_t type,
+                    long long nowMs, int passenger, int train, int station,
+                    int value = -1) const;
+  void pickNextStation(int id, long long nowMs);
+  void enqueueWaiting(int stationId, int passengerId);
+  void arriveAtStation(int id, long long nowMs, TickDelta &delta);
+  void runParallel(size_t count, size_t grain, const WorkerPool::RangeFn &fn);
+  void measureEdge(int station, int slot);
+
+  std::vector<SimStation> stations;
+  StringInterner stationNames;
+  std::vector<int> stationByName; // by name id
+  std::vector<SimTrain> trains;
+  PassengerStore passengers;
+  RoutingTable routes;
+  bool routesStale;
+  std::unique_ptr<DispatchPolicy> dispatch;
+  std::unique_ptr<DemandGenerator> demand;
+  std::unique_ptr<Journal> journal;
+  int journalScore; // last score written to the journal
+  uint64_t topologyVersion;
+  uint64_t layoutVersion;
+  float lineSpeed; // pixels per second
+
+  // Event-driven engine: (arrival tick, train) of every moving train
+  typedef std::pair<long long, int> TrainEvent;
+  Engine engine;
+  std::priority_queue<TrainEvent, std::vector<TrainEvent>,
+                      std::greater<TrainEvent>>
+      trainEvents;
+
+  // Parallel tick
+  std::unique_ptr<WorkerPool> pool;
+  std::vector<std::vector<std::pair<int, int>>> arrivalsByWorker;
+  std::vector<std::pair<int, int>> arrivals; // (station, train)
+  std::vector<size_t> stationGroups;         // start of each station's run
+  std::vector<int> waitingSnapshot;
+  std::vector<TickDelta> deltas;
+  bool resolvingArrivals;
+
+  ScoreKeeper scoring;
+  Histogram waitTimes;
+  uint64_t seed;
+  long long elapsedMs;
+  long long stepCount;
+  long long arrivalCount;
+  bool debugMode;
+};
+
+#endif // SIMULATION_H
@@ -0,0 +1,130 @@
+#ifndef SPATIAL_GRID_H
+#define SPATIAL_GRID_H
+
+#include <cmath>
+#include <cstdint>
+#include <unordered_map>
+#include <vector>
+
+/**
+ * @brief Uniform-grid spatial hash over points identified by dense ids.
+ *
+ * Points are bucketed into square cells of a fixed size; only the cells
+ * overlapping a query circle are visited, so picking costs O(points near
+ * the cursor) instead of O(all points). Cells are hashed, so the indexed
+ * area is unbounded. Moving a point is O(1) and only touches the buckets
+ * when it crosses into another cell.
+ */
+class SpatialGrid {
+private:
+  struct Entry {
+    float x;
+    float y;
+    int64_t cell;
+    bool present;
+  };
+
+  float cellSize;
+  std::vector<Entry> entries; // indexed by id
+  std::unordered_map<int64_t, std::vector<int>> cells;
+
+  int32_t cellCoord(float v) const {
+    return (int32_t)std::floor(v / cellSize);
+  }
+
+  static int64_t cellKey(int32_t cx, int32_t cy) {
+    return ((int64_t)cx << 32) ^ (int64_t)(uint32_t)cy;
+  }
+
+  void unlink(int id) {
+    std::vector<int> &bucket = cells[entries[id].cell];
+    for (size_t i = 0; i < bucket.size(); ++i) {
+      if (bucket[i] == id) {
+        bucket[i] = bucket.back();
+        bucket.pop_back();
+        break;
+      }
+    }
+    if (bucket.empty())
+      cells.erase(entries[id].cell);
+  }
+
+public:
+  explicit SpatialGrid(float cell = 32.0f) : cellSize(cell) {}
+
+  void clear() {
+    entries.clear();
+    cells.clear();
+  }
+
+  /**
+   * @brief Add a point, or move it if the id is already indexed
+   */
+  void insert(int id, float x, float y) {
+    if (id < (int)entries.size() && entries[id].present) {
+      update(id, x, y);
+      return;
+    }
+    if (id >= (int)entries.size())
+      entries.resize(id + 1, Entry{0.0f, 0.0f, 0, false});
+
+    int64_t key = cellKey(cellCoord(x), cellCoord(y));
+    entries[id] = Entry{x, y, key, true};
+    cells[key].push_back(id);
+  }
+
+  /**
+   * @brief Move an indexed point
+   */
+  void update(int id, float x, float y) {
+    Entry &e = entries[id];
+    int64_t key = cellKey(cellCoord(x), cellCoord(y));
+    if (key != e.cell) {
+      unlink(id);
+      e.cell = key;
+      cells[key].push_back(id);
+    }
+    e.x = x;
+    e.y = y;
+  }
+
+  void remove(int id) {
+    if (id >= (int)entries.size() || !entries[id].present)
+      return;
+    unlink(id);
+    entries[id].present = false;
+  }
+
+  /**
+   * @brief Closest indexed point within maxDist of (x, y)
+   * @return Its id, or -1 if there is none
+   */
+  int findNearest(float x, float y, float maxDist) const {
+    int32_t minX = cellCoord(x - maxDist), maxX = cellCoord(x + maxDist);
+    int32_t minY = cellCoord(y - maxDist), maxY = cellCoord(y + maxDist);
+
+    int best = -1;
+    float bestDistSq = maxDist * maxDist;
+    for (int32_t cx = minX; cx <= maxX; ++cx) {
+      for (int32_t cy = minY; cy <= maxY; ++cy) {
+        auto it = cells.find(cellKey(cx, cy));
+        if (it == cells.end())
+          continue;
+        for (int id : it->second) {
+          float dx = entries[id].x - x;
+          float dy = entries[id].y - y;
+          float distSq = dx * dx + dy * dy;
+          if (distSq < bestDistSq) {
+            best = id;
+            bestDistSq = distSq;
+          }
+        }
+      }
+    }
+    return best;
+  }
+
+  size_t size() const { return entries.size(); }
+};
+
+#endif // SPATIAL_GRID_H
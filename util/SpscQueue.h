@@ -0,0 +1,73 @@
+#ifndef SPSC_QUEUE_H
+#define SPSC_QUEUE_H
+
+#include <atomic>
+#include <cstddef>
+#include <vector>
+
+/**
+ * @brief Bounded lock-free queue for one producer and one consumer thread.
+ *
+ * The ring is a fixed power of two long and is allocated once. Each side
+ * owns one index and only reads the other's, so push() and pop() never
+ * lock; the indices sit on separate cache lines so the two threads do not
+ * contend for one. push() fails rather than blocks when the queue is full.
+ */
+template <typename T> class SpscQueue {
+private:
+  std::vector<T> buffer;
+  size_t mask;
+  alignas(64) std::atomic<size_t> head; // next slot to read, consumer's
+  alignas(64) std::atomic<size_t> tail; // next slot to write, producer's
+
+public:
+  /**
+   * @param capacity Rounded up to a power of two
+   */
+  explicit SpscQueue(size_t capacity) : head(0), tail(0) {
+    size_t size = 2;
+    while (size < capacity)
+      size *= 2;
+    buffer.resize(size);
+    mask = size - 1;
+  }
+
+  SpscQueue(const SpscQueue &) = delete;
+  SpscQueue &operator=(const SpscQueue &) = delete;
+
+  /**
+   * @brief Append an element (producer thread only)
+   * @return false if the queue is full
+   */
+  bool push(const T &value) {
+    size_t t = tail.load(std::memory_order_relaxed);
+    if (t - head.load(std::memory_order_acquire) > mask)
+      return false;
+    buffer[t & mask] = value;
+    tail.store(t + 1, std::memory_order_release);
+    return true;
+  }
+
+  /**
+   * @brief Move up to max elements, oldest first, into out (consumer
+   * thread only)
+   * @return Number of elements taken
+   */
+  size_t pop(T *out, size_t max) {
+    size_t h = head.load(std::memory_order_relaxed);
+    size_t available = tail.load(std::memory_order_acquire) - h;
+    size_t n = available < max ? available : max;
+    for (size_t i = 0; i < n; ++i)
+      out[i] = buffer[(h + i) & mask];
+    head.store(h + n, std::memory_order_release);
+    return n;
+  }
+
+  bool empty() const {
+    return head.load(std::memory_order_acquire) ==
+           tail.load(std::memory_order_acquire);
+  }
+  size_t capacity() const { return buffer.size(); }
+};
+
+#endif // SPSC_QUEUE_H
@@ -1,23 +1,29 @@
 #ifndef STATION_H
 #define STATION_H
 
-#include "Passenger.h"
+#include "Simulation.h"
 #include "VisualAsset.h"
-#include <algorithm>
 #include <iostream>
 #include <sgg/graphics.h>
 #include <string>
 #include <vector>
 
+/**
+ * @brief View of a SimStation: lets the user drag it around and labels it
+ * on hover.
+ *
+ * Position, connections and waiting riders live in the Simulation; the view
+ * mirrors the position into VisualAsset::x/y and writes it back while the
+ * station is being dragged. Mouse input is routed to a single station per
+ * frame by GlobalState, so a view never tests the cursor itself.
+ */
 class Station : public VisualAsset {
 private:
-  std::string name;
+  Simulation &sim;
+  int id;
   float radius;
   graphics::Brush brush;
   int passengerCount;
-  std::vector<Station *> next;
-  std::vector<Station *> prev;
-  std::vector<Passenger *> waitingPassengers;
 
   // Dragging state
   bool isDragging;
@@ -30,12 +36,15 @@ private:
   float x2 = -1;
   float y2 = -1;
 
+  bool hovered;
+
 public:
-  Station(float posX, float posY, const std::string &stationName,
-          float r = 15.0f)
-      : VisualAsset(posX, posY), name(stationName), radius(r),
-        passengerCount(0), isDragging(false), dragOffsetX(0.0f),
-        dragOffsetY(0.0f) {
+  Station(Simulation &simulation, int stationId, float r = 15.0f)
+      : VisualAsset(simulation.getStation(stationId).x,
+                    simulation.getStation(stationId).y),
+        sim(simulation), id(stationId), radius(r), passengerCount(0),
+        isDragging(false), dragOffsetX(0.0f), dragOffsetY(0.0f),
+        hovered(false) {
 
     brush.fill_color[0] = 0.2f;
     brush.fill_color[1] = 0.6f;
@@ -44,24 +53,22 @@ public:
     brush.outline_width = 3.0f;
   }
 
-  void addNext(Station *other) {
-    if (other) {
-      next.push_back(other);
-      other->prev.push_back(this);
-    }
+  ~Station() {
+    if (s_active_dragging_station == this)
+      s_active_dragging_station = nullptr;
   }
 
   /**
-   * @brief Update the station state
-   * @param ms Milliseconds elapsed since last update
+   * @brief Handle the mouse for this station
+   * @param mx Mouse X in canvas coordinates
+   * @param my Mouse Y in canvas coordinates
    * @param mouse Current mouse state
+   *
+   * GlobalState calls this only for the one station under the cursor (or
+   * the one being dragged), found through its spatial index.
    */
-  void update(int ms, const graphics::MouseState &mouse) override {
-    (void)ms;
-
-    // Convert mouse position to canvas coordinates
-    float mx = graphics::windowToCanvasX((float)mouse.cur_pos_x);
-    float my = graphics::windowToCanvasY((float)mouse.cur_pos_y);
+  void handleMouse(float mx, float my, const graphics::MouseState &mouse) {
+    const SimStation &station = sim.getStation(id);
 
     if (mouse.button_left_down) {
       // 1. Check if we should START dragging
@@ -77,7 +84,9 @@ public:
           s_active_dragging_station = this; // Claim global lock
           dragOffsetX = mx - x;
           dragOffsetY = my - y;
-          std::cout << "DEBUG: Clicked on " << name << std::endl;
+          if (sim.isDebugMode())
+            std::cout << "DEBUG: Clicked on " << sim.getStationName(id)
+                      << std::endl;
         }
       }
 
@@ -91,115 +100,121 @@ public:
         if (x2 != x || y2 != y) {
           x2 = x;
           y2 = y;
-          for (Passenger *p : waitingPassengers) {
-            p->setPosition(x, y);
-          }
+          sim.setStationPosition(id, x, y);
+          station.forEachWaiting(
+              [&](int pid) { sim.setPassengerPosition(pid, x, y); });
         }
       }
     } else {
       // 3. Handle RELEASE
       if (isDragging && s_active_dragging_station == this) {
-        std::cout << "DEBUG: Released " << name << std::endl;
+        if (sim.isDebugMode())
+          std::cout << "DEBUG: Released " << sim.getStationName(id)
+                    << std::endl;
         s_active_dragging_station = nullptr; // Release global lock
       }
       isDragging = false;
+    }
+  }
 
-      // RESTORED: Your original passenger alignment logic
-      float passenger_row_offset = radius * (1.0f / 6.0f);
-      float passenger_spacing =
-          radius / (static_cast<float>(passengerCount / 2) + 1.0f);
-
-      int passenger_in_row_idx = 0;
-      for (size_t i = 0; i < waitingPassengers.size(); ++i) {
-        Passenger *p = waitingPassengers[i];
-        float pasx, pasy;
-
-        if (i % 2 == 0) { // Even index: top row
-          pasy = y + passenger_row_offset - 5;
-          pasx = x - radius / 2.0f +
-                 (passenger_in_row_idx + 1) * passenger_spacing;
-        } else { // Odd index: bottom row
-          pasy = y - passenger_row_offset - 10;
-          pasx = x - radius / 2.0f +
-                 (passenger_in_row_idx + 1) * passenger_spacing;
-          passenger_in_row_idx++;
-        }
-        // Your specific offset: pasx - radius - 5, pasy - radius * 1.5f
-        p->setPosition(pasx - radius - 7.5, pasy - radius * 1.5f);
+  /**
+   * @brief Update the station state
+   * @param ms Milliseconds elapsed since last update
+   * @param mouse Current mouse state (unused, see handleMouse())
+   *
+   * Mirrors the simulated position and lays the waiting riders out on the
+   * platform.
+   */
+  void update(int ms, const graphics::MouseState &mouse) override {
+    (void)ms;
+    (void)mouse;
+
+    if (isDragging)
+      return; // riders follow the station in handleMouse()
+
+    const SimStation &station = sim.getStation(id);
+    x = station.x;
+    y = station.y;
+
+    // RESTORED: Your original passenger alignment logic
+    float passenger_row_offset = radius * (1.0f / 6.0f);
+    float passenger_spacing =
+        radius / (static_cast<float>(passengerCount / 2) + 1.0f);
+
+    int passenger_in_row_idx = 0;
+    size_t i = 0;
+    station.forEachWaiting([&](int pid) {
+      float pasx, pasy;
+
+      if (i % 2 == 0) { // Even index: top row
+        pasy = y + passenger_row_offset - 5;
+        pasx =
+            x - radius / 2.0f + (passenger_in_row_idx + 1) * passenger_spacing;
+      } else { // Odd index: bottom row
+        pasy = y - passenger_row_offset - 10;
+        pasx =
+            x - radius / 2.0f + (passenger_in_row_idx + 1) * passenger_spacing;
+        passenger_in_row_idx++;
       }
-    }
+      // Your specific offset: pasx - radius - 5, pasy - radius * 1.5f
+      sim.setPassengerPosition(pid, pasx - radius - 7.5f,
+                               pasy - radius * 1.5f);
+      i++;
+    });
   }
 
+  /**
+   * @brief Draw the hover label and highlight
+   *
+   * The disk itself and the tracks are drawn in batches by NetworkLayer,
+   * so only the hovered station has anything left to draw.
+   */
   void draw() override {
-    if (!active)
+    if (!active || !hovered)
       return;
 
-    // Draw connections
-    graphics::Brush lineBrush;
-    lineBrush.outline_opacity = 1.0f;
-    lineBrush.outline_width = 0.8f;
-    lineBrush.outline_color[0] = 0.5f;
-    lineBrush.outline_color[1] = 0.5f;
-    lineBrush.outline_color[2] = 0.5f;
-
-    for (Station *s : next) {
-      if (s && s->getIsActive()) {
-        graphics::drawLine(x, y, s->getX(), s->getY(), lineBrush);
-      }
-    }
-
-    graphics::drawDisk(x, y, radius, brush);
-
-    graphics::MouseState ms;
-    graphics::getMouseState(ms);
-    float mx = graphics::windowToCanvasX((float)ms.cur_pos_x);
-    float my = graphics::windowToCanvasY((float)ms.cur_pos_y);
-
-    float dx = std::abs(mx - x);
-    float dy = std::abs(my - y);
-
-    // Hover effect
-    if (dx < radius && dy < radius) {
-      graphics::Brush textBrush;
-      textBrush.fill_color[0] = 1.0f;
-      textBrush.fill_color[1] = 1.0f;
-      textBrush.fill_color[2] = 1.0f;
-
-      graphics::Brush bgBrush;
-      bgBrush.fill_color[0] = 0.2f;
-      bgBrush.fill_opacity = 0.8f;
-
-      float textWidth = name.length() * 8.0f;
-      graphics::drawRect(x, y + radius + 25, textWidth + 10, 20, bgBrush);
-      graphics::drawText(x - textWidth / 2, y + radius + 30, 14, name,
-                         textBrush);
-
-      graphics::Brush highlightBrush = brush;
-      highlightBrush.fill_opacity = 0.5f;
-      highlightBrush.outline_color[0] = 1.0f;
-      graphics::drawDisk(x, y, radius + 2, highlightBrush);
-    }
+    graphics::Brush textBrush;
+    textBrush.fill_color[0] = 1.0f;
+    textBrush.fill_color[1] = 1.0f;
+    textBrush.fill_color[2] = 1.0f;
+
+    graphics::Brush bgBrush;
+    bgBrush.fill_color[0] = 0.2f;
+    bgBrush.fill_opacity = 0.8f;
+
+    const std::string &name = sim.getStationName(id);
+    float textWidth = name.length() * 8.0f;
+    graphics::drawRect(x, y + radius + 25, textWidth + 10, 20, bgBrush);
+    graphics::drawText(x - textWidth / 2, y + radius + 30, 14, name,
+                       textBrush);
+
+    graphics::Brush highlightBrush = brush;
+    highlightBrush.fill_opacity = 0.5f;
+    highlightBrush.outline_color[0] = 1.0f;
+    graphics::drawDisk(x, y, radius + 2, highlightBrush);
   }
 
   // Getters / Setters
-  std::string getName() const { return name; }
-  void setName(const std::string &newName) { name = newName; }
+  int getId() const { return id; }
+  float getRadius() const { return radius; }
+  bool getIsDragging() const { return isDragging; }
+  void setHovered(bool h) {
+    if (hovered != h)
+      markDirty();
+    hovered = h;
+  }
+  static Station *getActiveDraggingStation() {
+    return s_active_dragging_station;
+  }
+  const std::string &getName() const { return sim.getStationName(id); }
   int getPassengerCount() const { return passengerCount; }
   void addPassenger() { passengerCount++; }
   void removePassenger() {
     if (passengerCount > 0)
       passengerCount--;
   }
-  const std::vector<Station *> &getNext() const { return next; }
-  void addWaitingPassenger(Passenger *p) { waitingPassengers.push_back(p); }
-  void removeWaitingPassenger(Passenger *p) {
-    auto it = std::find(waitingPassengers.begin(), waitingPassengers.end(), p);
-    if (it != waitingPassengers.end())
-      waitingPassengers.erase(it);
-  }
-  const std::vector<Passenger *> &getWaitingPassengers() const {
-    return waitingPassengers;
-  }
+  const std::vector<int> &getNext() const { return sim.getStation(id).next; }
+  int getWaitingCount() const { return sim.getStation(id).waitingCount; }
 };
 
-#endif
\ No newline at end of file
+#endif
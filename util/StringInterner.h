@@ -0,0 +1,112 @@
+#ifndef STRING_INTERNER_H
+#define STRING_INTERNER_H
+
+#include <cstddef>
+#include <cstdint>
+#include <deque>
+#include <string>
+#include <string_view>
+#include <vector>
+
+/**
+ * @brief Gives every distinct string a dense integer id.
+ *
+ * Lookup goes through a flat open-addressing table (linear probing,
+ * power-of-two size, at most half full) holding ids, with the full hash of
+ * each string kept alongside so most mismatches are rejected without a
+ * string compare. Strings live in a deque, so references returned by get()
+ * stay valid as more strings are interned.
+ */
+class StringInterner {
+public:
+  static constexpr uint32_t kNotFound = 0xFFFFFFFFu;
+
+private:
+  std::deque<std::string> strings; // by id
+  std::vector<uint64_t> hashes;    // by id
+  std::vector<uint32_t> slots;     // ids, kNotFound when empty
+  size_t mask;
+
+  static uint64_t hash(std::string_view s) {
+    uint64_t h = 14695981039346656037ULL;
+    for (char c : s) {
+      h ^= (unsigned char)c;
+      h *= 1099511628211ULL;
+    }
+    return h;
+  }
+
+  size_t findSlot(std::string_view s, uint64_t h) const {
+    size_t slot = (size_t)h & mask;
+    while (slots[slot] != kNotFound) {
+      uint32_t id = slots[slot];
+      if (hashes[id] == h && strings[id] == s)
+        break;
+      slot = (slot + 1) & mask;
+    }
+    return slot;
+  }
+
+  void grow() {
+    std::vector<uint32_t> old;
+    old.swap(slots);
+    slots.assign(old.empty() ? 16 : old.size() * 2, kNotFound);
+    mask = slots.size() - 1;
+    for (uint32_t id = 0; id < (uint32_t)strings.size(); ++id) {
+      size_t slot = (size_t)hashes[id] & mask;
+      while (slots[slot] != kNotFound)
+        slot = (slot + 1) & mask;
+      slots[slot] = id;
+    }
+  }
+
+public:
+  StringInterner() : mask(0) { grow(); }
+
+  /**
+   * @brief Id of a string, adding it if it is new
+   */
+  uint32_t intern(std::string_view s) {
+    uint64_t h = hash(s);
+    size_t slot = findSlot(s, h);
+    if (slots[slot] != kNotFound)
+      return slots[slot];
+
+    uint32_t id = (uint32_t)strings.size();
+    strings.emplace_back(s);
+    hashes.push_back(h);
+    if ((strings.size()) * 2 > slots.size())
+      grow();
+    else
+      slots[slot] = id;
+    return id;
+  }
+
+  /**
+   * @brief Id of a string, or kNotFound if it was never interned
+   */
+  uint32_t find(std::string_view s) const {
+    return slots[findSlot(s, hash(s))];
+  }
+
+  const std::string &get(uint32_t id) const { return strings[id]; }
+  size_t size() const { return strings.size(); }
+
+  /**
+   * @brief Make room for count strings without rehashing
+   */
+  void reserve(size_t count) {
+    hashes.reserve(count);
+    while (count * 2 > slots.size())
+      grow();
+  }
+
+  void clear() {
+    strings.clear();
+    hashes.clear();
+    slots.clear();
+    grow();
+  }
+};
+
+#endif // STRING_INTERNER_H
@@ -1,11 +1,8 @@
 #ifndef TRAIN_H
 #define TRAIN_H
 
-#include "GlobalState.h"
-#include "Passenger.h"
-#include "Station.h"
+#include "Simulation.h"
 #include "VisualAsset.h"
-#include <cmath>
 #include <iostream>
 #include <sgg/graphics.h>
 #include <string>
@@ -13,117 +10,32 @@
 
 using namespace graphics;
 
+/**
+ * @brief View of a SimTrain: draws the carriage and lays out its riders.
+ *
+ * Movement, boarding and routing are handled by the Simulation; this class
+ * only mirrors the train position and arranges the onboard passengers.
+ * Its heading comes from the simulation's cached edge geometry, so neither
+ * update() nor draw() does any trigonometry.
+ */
 class Train : public VisualAsset {
 private:
+  Simulation &sim;
+  int id;
   Brush brush;
-  std::vector<Passenger *> passengers;
-  int capacity = 6;
-  float speed;
   float height = 38.0;
   float width = 22.0;
 
-  Station *currentStation;
-  Station *nextStation;
-  Station *previousStation;
-
-  // For smooth movement
-  float t; // interpolation factor 0..1
-
 public:
-  Train(float posX, float posY, Station *startStation)
-      : VisualAsset(posX, posY), capacity(6), speed(0.0005f),
-        currentStation(startStation), nextStation(nullptr),
-        previousStation(nullptr), t(0.0f) {
-    x = posX;
-    y = posY;
+  Train(Simulation &simulation, int trainId)
+      : VisualAsset(simulation.getTrain(trainId).x,
+                    simulation.getTrain(trainId).y),
+        sim(simulation), id(trainId) {
     // Brush so Train's colour is gray
     brush.fill_color[0] = 0.65f;
     brush.fill_color[1] = 0.65f;
     brush.fill_color[2] = 0.65f;
     brush.outline_opacity = 0.0f;
-
-    // Pick initial random next station if available
-    pickNextStation();
-  }
-
-  void pickNextStation() {
-    if (!currentStation)
-      return;
-    const auto &connections = currentStation->getNext();
-    if (connections.empty()) {
-      nextStation = nullptr;
-      return;
-    }
-
-    // Randomly pick next station
-    std::vector<Station *> validConnections;
-    for (Station *s : connections) {
-      if (s != previousStation) {
-        validConnections.push_back(s);
-      }
-    }
-
-    // If dead end (only connection is previous), go back
-    if (validConnections.empty()) {
-      validConnections = connections;
-    }
-
-    // Randomly pick next station from valid connections
-    int idx = std::rand() % validConnections.size();
-    nextStation = validConnections[idx];
-    t = 0.0f;
-  }
-
-  void arriveAtStation() {
-    previousStation = currentStation;
-    currentStation = nextStation;
-    nextStation = nullptr;
-    t = 0.0f;
-
-    // 1. Disembark passengers
-    for (auto it = passengers.begin(); it != passengers.end();) {
-      Passenger *p = *it;
-      if (p->getDestination() == currentStation) {
-        p->setState(Passenger::COMPLETED);
-        // p->setActive(false); // Maybe hide them or keep them visible at
-        // station? For now, let's just remove them from train
-        it = passengers.erase(it);
-        GlobalState::getInstance().addScore(10);
-        if (GlobalState::getInstance().isDebugMode()) {
-          std::cout << "Passenger disembarked at " << currentStation->getName()
-                    << std::endl;
-        }
-      } else {
-        ++it;
-      }
-    }
-
-    // Iterate over a copy of waiting passengers to avoid iterator
-    // invalidation specific issues or just loop and remove.
-    std::vector<Passenger *> boarding;
-    const auto &waiting = currentStation->getWaitingPassengers();
-
-    for (Passenger *p : waiting) {
-      if ((int)passengers.size() + (int)boarding.size() <
-          capacity) { // classic java-style cast
-        boarding.push_back(p);
-      } else {
-        break;
-      }
-    }
-
-    for (Passenger *p : boarding) {
-      currentStation->removeWaitingPassenger(p);
-      p->setState(Passenger::ON_TRAIN);
-      passengers.push_back(p);
-      if (GlobalState::getInstance().isDebugMode()) {
-        std::cout << "Passenger embarked at " << currentStation->getName()
-                  << std::endl;
-      }
-    }
-
-    // 3. Move to next
-    pickNextStation();
   }
 
   // Draw Train as a Rectangle
@@ -131,68 +43,42 @@ public:
     if (!active)
       return;
 
-    // Rotate towards next station
-    if (currentStation && nextStation) {
-      // Get cords of each station
-      float cx = currentStation->getX();
-      float cy = currentStation->getY();
-      float nx = nextStation->getX();
-      float ny = nextStation->getY();
-      // Calculate slope with them and use arctan to convert to degrees
-      float slope =
-          atan((ny - cy) / (cx - nx)); // the y axis is inverted (also using
-                                       // atan to use slope again later)
-      float angle = slope * 180 / M_PI;
-      graphics::setOrientation(angle + 90);
+    const SimTrain &train = sim.getTrain(id);
+
+    // Rotate towards next station, lengthwise along the track
+    if (train.currentStation >= 0 && train.nextSlot >= 0) {
+      const SimEdge &edge = sim.getEdge(train.currentStation, train.nextSlot);
+      graphics::setOrientation(edge.angle + 90);
     }
 
     drawRect(x, y, width, height, brush);
     resetPose(); // Reset rotation for other objects
   }
 
-  void update(int ms, const MouseState &) override {
-    if (!GlobalState::getInstance().isSimulating())
-      return;
-    if (!currentStation || !nextStation)
-      return;
+  void update(int, const MouseState &) override {
+    const SimTrain &train = sim.getTrain(id);
+    x = train.x;
+    y = train.y;
 
-    // "Lerp" towards next station
-    float dt = (float)ms * speed;
-    t += dt;
-
-    if (t >= 1.0f) {
-      arriveAtStation();
-    } else {
-      // Linear interpolation
-      float startX = currentStation->getX();
-      float startY = currentStation->getY();
-      float endX = nextStation->getX();
-      float endY = nextStation->getY();
-
-      x = startX + (endX - startX) * t;
-      y = startY + (endY - startY) * t;
-    }
+    if (train.currentStation < 0 || train.nextSlot < 0)
+      return;
 
     // Update passengers position to follow train
     // Arrange passengers in two rows, alternating positions
     float passenger_row_offset =
         height * (1.0f / 6.0f); // Offset from train center for rows
     float passenger_spacing =
-        width / (static_cast<float>(capacity / 2) +
+        width / (static_cast<float>(train.capacity / 2) +
                  1.0f); // Spacing between passengers in a row
 
-    // Calculate train rotation angle based on movement direction
-    float dx = nextStation->getX() - currentStation->getX();
-    float dy = nextStation->getY() - currentStation->getY();
-    float angle = std::atan2(dy, dx) +
-                  M_PI / 2.0f; // Rotate so -Y (top) points to direction
-
-    float c = std::cos(angle);
-    float s = std::sin(angle);
+    // Rotation by the direction of travel plus 90 degrees, so -Y (top)
+    // points along the track: cos(a + 90) = -sin(a), sin(a + 90) = cos(a)
+    const SimEdge &edge = sim.getEdge(train.currentStation, train.nextSlot);
+    float c = -edge.dirY;
+    float s = edge.dirX;
 
     int passenger_in_row_idx = 0; // Index for passenger within their row
-    for (size_t i = 0; i < passengers.size(); ++i) {
-      Passenger *p = passengers[i];
+    for (size_t i = 0; i < train.passengers.size(); ++i) {
       float local_x, local_y;
 
       // Calculate local position relative to train center (0,0)
@@ -216,12 +102,15 @@ public:
       float rotated_x = local_x * c - local_y * s;
       float rotated_y = local_x * s + local_y * c;
 
-      p->setPosition(x + rotated_x, y + rotated_y); // Set new global position
+      sim.setPassengerPosition(train.passengers[i], x + rotated_x,
+                               y + rotated_y); // Set new global position
     }
   };
 
   // Get number of Passengers
-  int getPassengerCount() const { return (int)passengers.size(); }
+  int getPassengerCount() const {
+    return (int)sim.getTrain(id).passengers.size();
+  }
 };
 
 #endif // TRAIN_H
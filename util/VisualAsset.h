@@ -21,6 +21,7 @@ protected:
     bool isDragging; // Whether this asset is currently being dragged
     float dragOffsetX; // X offset for dragging
     float dragOffsetY; // Y offset for dragging
+    bool dirty;     // Whether the asset looks different since last checked
     
 public:
     /**
@@ -29,7 +30,8 @@ public:
      @param posY Initial Y position
      */
     VisualAsset(float posX = 0.0f, float posY = 0.0f) 
-        : x(posX), y(posY), active(true), dragOffsetX(0.0f), dragOffsetY(0.0f) {}
+        : x(posX), y(posY), active(true), dragOffsetX(0.0f), dragOffsetY(0.0f),
+          dirty(true) {}
 
     /**
      * @brief Virtual destructor to ensure proper cleanup of derived classes
@@ -60,14 +62,37 @@ public:
     bool getIsActive() const { return active; }
     bool getIsDragging() const { return isDragging; }
 
+    /**
+     * @brief Dirty tracking for idle frame pacing
+     *
+     * Assets mark themselves dirty when their on-screen state changes
+     * (hover, position, visibility). GlobalState collects and clears the
+     * flags each frame and slows the frame rate while nothing is dirty.
+     */
+    bool isDirty() const { return dirty; }
+    void markDirty() { dirty = true; }
+    void clearDirty() { dirty = false; }
+
     // Setters
-    void setX(float posX) { x = posX; }
-    void setY(float posY) { y = posY; }
+    void setX(float posX) { x = posX; dirty = true; }
+    void setY(float posY) { y = posY; dirty = true; }
     void setPosition(float posX, float posY) { 
         x = posX; 
         y = posY; 
+        dirty = true;
     }
-    void setActive(bool isActive) { active = isActive; }
+    void setActive(bool isActive) {
+        if (active != isActive) dirty = true;
+        active = isActive;
+    }
+
+private:
+    friend class GlobalState;
+
+    // Where GlobalState lists this asset (category and index in it), so it
+    // can be unlisted in O(1); -1 while the asset is not registered
+    int registryList = -1;
+    int registryIndex = -1;
 };
 
 #endif // VISUAL_ASSET_H
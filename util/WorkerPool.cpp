@@ -0,0 +1,73 @@
+#include "WorkerPool.h"
+#include "Profiler.h"
+#include <string>
+
+WorkerPool::WorkerPool(int workers)
+    : generation(0), pending(0), stopping(false), job(nullptr), jobCount(0),
+      chunkSize(0) {
+  for (int i = 1; i < workers; ++i)
+    threads.emplace_back(&WorkerPool::workerLoop, this, i);
+}
+
+WorkerPool::~WorkerPool() {
+  {
+    std::lock_guard<std::mutex> lock(mutex);
+    stopping = true;
+  }
+  wake.notify_all();
+  for (std::thread &thread : threads)
+    thread.join();
+}
+
+void WorkerPool::parallelFor(size_t count, size_t grain, const RangeFn &fn) {
+  if (count == 0)
+    return;
+  size_t workers = (size_t)size();
+  if (workers == 1 || count < grain * 2) {
+    fn(0, count, 0);
+    return;
+  }
+
+  {
+    std::lock_guard<std::mutex> lock(mutex);
+    job = &fn;
+    jobCount = count;
+    chunkSize = (count + workers - 1) / workers;
+    pending = (int)threads.size();
+    generation++;
+  }
+  wake.notify_all();
+
+  runChunk(0);
+
+  std::unique_lock<std::mutex> lock(mutex);
+  done.wait(lock, [this] { return pending == 0; });
+  job = nullptr;
+}
+
+void WorkerPool::runChunk(int worker) {
+  size_t begin = (size_t)worker * chunkSize;
+  size_t end = begin + chunkSize < jobCount ? begin + chunkSize : jobCount;
+  if (begin < end)
+    (*job)(begin, end, worker);
+}
+
+void WorkerPool::workerLoop(int worker) {
+  Profiler::setThreadName("worker " + std::to_string(worker));
+  uint64_t seen = 0;
+  for (;;) {
+    {
+      std::unique_lock<std::mutex> lock(mutex);
+      wake.wait(lock, [&] { return stopping || generation != seen; });
+      if (stopping)
+        return;
+      seen = generation;
+    }
+
+    runChunk(worker);
+
+    std::lock_guard<std::mutex> lock(mutex);
+    if (--pending == 0)
+      done.notify_one();
+  }
+}
@@ -0,0 +1,62 @@
+#ifndef WORKER_POOL_H
+#define WORKER_POOL_H
+
+#include <condition_variable>
+#include <cstddef>
+#include <cstdint>
+#include <functional>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+/**
+ * @brief Fixed set of worker threads for data-parallel loops.
+ *
+ * parallelFor() splits a range into one contiguous chunk per worker and
+ * blocks until every chunk is done. The calling thread runs chunk 0, so a
+ * pool of N workers owns N - 1 threads. Chunks are assigned by worker index
+ * only, never by timing, so code that keeps per-worker results and merges
+ * them in worker order is deterministic.
+ */
+class WorkerPool {
+public:
+  /// fn(begin, end, worker) processes items [begin, end)
+  typedef std::function<void(size_t, size_t, int)> RangeFn;
+
+  explicit WorkerPool(int workers);
+  ~WorkerPool();
+
+  WorkerPool(const WorkerPool &) = delete;
+  WorkerPool &operator=(const WorkerPool &) = delete;
+
+  /**
+   * @brief Number of workers, including the calling thread
+   */
+  int size() const { return (int)threads.size() + 1; }
+
+  /**
+   * @brief Run fn over [0, count) on every worker and wait for it
+   * @param grain Ranges shorter than grain per worker run inline on the
+   * caller, where waking the pool would cost more than it saves
+   */
+  void parallelFor(size_t count, size_t grain, const RangeFn &fn);
+
+private:
+  void workerLoop(int worker);
+  void runChunk(int worker);
+
+  std::vector<std::thread> threads;
+  std::mutex mutex;
+  std::condition_variable wake;
+  std::condition_variable done;
+  uint64_t generation;
+  int pending;
+  bool stopping;
+
+  // Current job, valid while pending > 0
+  const RangeFn *job;
+  size_t jobCount;
+  size_t chunkSize;
+};
+
+#endif // WORKER_POOL_H